@@ -11,6 +11,18 @@ Projects = {
 		LibsRelease = {},
 		AdditionalDependencies = {}
 	},
+	{
+		Name = "ErewhonBenchmark",
+		Kind = "ConsoleApp",
+		Defines = {"NDK_SERVER"},
+		Files = {"../include/Shared/**", "../src/Shared/**", "../src/Server/**", "../src/Benchmark/**"},
+		ExcludedFiles = {"../src/Server/main.cpp"},
+		Includes = {"../thirdparty/include"},
+		Libs = os.istarget("windows") and {"libpq"} or {"pq", "pthread"},
+		LibsDebug = {"argon2-d", "NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"argon2", "NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"libeay32", "libintl-8", "libiconv-2", "Newton", "ssleay32"}
+	},
 	{
 		Name = "ErewhonClient",
 		Kind = "ConsoleApp",
@@ -22,6 +34,17 @@ Projects = {
 		LibsRelease = {"argon2", "NazaraAudio", "NazaraCore", "NazaraLua", "NazaraGraphics", "NazaraNetwork", "NazaraNoise", "NazaraRenderer", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraPlatform", "NazaraSDK", "NazaraUtility"},
 		AdditionalDependencies = {"Newton", "libsndfile-1", "soft_oal"}
 	},
+	{
+		Name = "ErewhonLoadTest",
+		Kind = "ConsoleApp",
+		Defines = {"NDK_SERVER"},
+		Files = {"../include/Shared/**", "../src/Shared/**", "../src/Client/ClientApplication", "../src/Client/ClientCommandStore", "../src/Client/ServerConnection", "../src/LoadTest/**"},
+		Includes = {"../thirdparty/include"},
+		Libs = os.istarget("windows") and {} or {"pthread"},
+		LibsDebug = {"argon2-d", "NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"argon2", "NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
+	},
 	{
 		Name = "ErewhonServer",
 		Kind = "ConsoleApp",
@@ -108,6 +131,10 @@ workspace(WorkspaceName)
 				end
 			end
 
+			if (data.ExcludedFiles) then
+				removefiles(data.ExcludedFiles)
+			end
+
 
 			debugdir("../bin/%{cfg.buildcfg}")
 			targetdir("../bin/%{cfg.buildcfg}")
@@ -1,8 +1,9 @@
 dofile("coptions.lua")
 
 Server = {
-	Address = "localhost",
-	Port    = 2049
+	Address   = "localhost",
+	Port      = 2049,
+	PortCount = 2 -- Should match server ReactorCount, a random port in [Port, Port + PortCount) is tried first, then the other ones
 }
 
 AssetsFolder = "Assets/"
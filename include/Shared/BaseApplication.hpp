@@ -24,6 +24,7 @@ namespace ewn
 			inline ConfigFile& GetConfig();
 			inline const ConfigFile& GetConfig() const;
 			inline std::size_t GetReactorCount() const;
+			inline NetworkReactor::QueueMetrics GetReactorQueueMetrics(std::size_t reactorId) const;
 
 			inline bool LoadConfig(const std::string& configFile);
 
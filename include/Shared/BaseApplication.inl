@@ -21,6 +21,12 @@ namespace ewn
 		return m_reactors.size();
 	}
 
+	inline NetworkReactor::QueueMetrics BaseApplication::GetReactorQueueMetrics(std::size_t reactorId) const
+	{
+		assert(reactorId < m_reactors.size());
+		return m_reactors[reactorId]->GetQueueMetrics();
+	}
+
 	inline bool BaseApplication::LoadConfig(const std::string& configFile)
 	{
 		if (m_config.LoadFromFile(configFile))
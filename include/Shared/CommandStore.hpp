@@ -58,6 +58,8 @@ namespace ewn
 		private:
 			using HandleFunction = std::function<void(Nz::NetPacket& packet)>;
 
+			bool UnserializeMessage(std::size_t peerId, Nz::NetPacket&& packet) const;
+
 			std::vector<IncomingCommand> m_incomingCommands;
 			std::vector<OutgoingCommand> m_outgoingCommands;
 	};
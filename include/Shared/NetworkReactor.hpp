@@ -12,6 +12,7 @@
 #include <concurrentqueue/concurrentqueue.h>
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <variant>
 #include <vector>
 
@@ -28,6 +29,9 @@ namespace ewn
 	{
 		public:
 			struct PeerInfo;
+			struct QueueMetrics;
+
+			using SharedPacket = std::shared_ptr<const Nz::NetPacket>;
 
 			NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient);
 			NetworkReactor(const NetworkReactor&) = delete;
@@ -41,10 +45,12 @@ namespace ewn
 			void Poll(ConnectCB&& onConnection, DisconnectCB&& onDisconnection, DataCB&& onData, InfoCB&& onInfo);
 
 			inline Nz::NetProtocol GetProtocol() const;
+			QueueMetrics GetQueueMetrics() const;
 
 			void QueryInfo(std::size_t peerId);
 
 			void SendData(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet);
+			void SendData(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, SharedPacket packet);
 
 			NetworkReactor& operator=(const NetworkReactor&) = delete;
 			NetworkReactor& operator=(NetworkReactor&&) = delete;
@@ -55,12 +61,26 @@ namespace ewn
 				Nz::UInt32 ping;
 			};
 
+			struct QueueMetrics
+			{
+				std::size_t incomingDepth;
+				std::size_t outgoingDepth;
+				std::size_t peakIncomingCount; //< Most events handled by a single Poll
+				std::size_t peakOutgoingCount; //< Most events handled by a single send pass
+			};
+
+			static constexpr std::size_t EventBatchSize = 64; //< Events dequeued at once from reactor queues
+
 			static constexpr std::size_t InvalidPeerId = std::numeric_limits<std::size_t>::max();
+			static constexpr std::size_t MaxBatchSize = 1200; //< Messages are coalesced up to this size, to fit in a single datagram
 	
 		private:
+			void FlushBatch(std::size_t batchIndex);
+			void FlushPeerBatches(std::size_t peerId);
 			void HandleConnectionRequests(const moodycamel::ConsumerToken& token);
+			void QueueMessage(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& message);
 			void ReceivePackets(const moodycamel::ProducerToken& producterToken);
-			void SendPackets(const moodycamel::ProducerToken& producterToken, const moodycamel::ConsumerToken& token);
+			void SendPackets(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token);
 			void WorkerThread();
 
 			struct ConnectionRequest
@@ -111,16 +131,38 @@ namespace ewn
 
 				struct QueryPeerInfo {};
 
+				struct SharedPacketEvent
+				{
+					Nz::ENetPacketFlags flags;
+					Nz::UInt8 channelId;
+					SharedPacket packet;
+				};
+
 				std::size_t peerId = InvalidPeerId;
-				std::variant<DisconnectEvent, PacketEvent, QueryPeerInfo> data;
+				std::variant<DisconnectEvent, PacketEvent, QueryPeerInfo, SharedPacketEvent> data;
+			};
+
+			struct PendingBatch
+			{
+				Nz::ENetPacketFlags flags;
+				Nz::NetPacket packet;
+				std::size_t messageCount = 0;
 			};
 
 			std::atomic_bool m_running;
+			std::atomic_size_t m_peakIncomingCount;
+			std::atomic_size_t m_peakOutgoingCount;
 			std::size_t m_firstId;
+			std::vector<std::size_t> m_activeBatches;
 			std::vector<Nz::ENetPeer*> m_clients;
+			std::vector<PendingBatch> m_pendingBatches; //< Indexed by peerId * NetworkChannelCount + channelId
 			moodycamel::ConcurrentQueue<ConnectionRequest> m_connectionRequests;
 			moodycamel::ConcurrentQueue<IncomingEvent> m_incomingQueue;
 			moodycamel::ConcurrentQueue<OutgoingEvent> m_outgoingQueue;
+			moodycamel::ConsumerToken m_pollToken;
+			std::vector<IncomingEvent> m_pollEvents;
+			std::vector<IncomingEvent> m_receivedEvents;
+			std::vector<OutgoingEvent> m_sendEvents;
 			Nz::ENetHost m_host;
 			Nz::NetProtocol m_protocol;
 			Nz::Thread m_thread;
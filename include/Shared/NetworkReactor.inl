@@ -10,32 +10,43 @@ namespace ewn
 	template<typename ConnectCB, typename DisconnectCB, typename DataCB, typename InfoCB>
 	void NetworkReactor::Poll(ConnectCB&& onConnection, DisconnectCB&& onDisconnection, DataCB&& onData, InfoCB&& onInfo)
 	{
-		IncomingEvent inEvent;
-		while (m_incomingQueue.try_dequeue(inEvent))
+		std::size_t eventCount;
+		std::size_t totalCount = 0;
+		while ((eventCount = m_incomingQueue.try_dequeue_bulk(m_pollToken, m_pollEvents.begin(), m_pollEvents.size())) > 0)
 		{
-			std::visit([&](auto&& arg) {
-				using T = std::decay_t<decltype(arg)>;
-				if constexpr (std::is_same_v<T, IncomingEvent::ConnectEvent>)
-				{
-					onConnection(arg.outgoingConnection, inEvent.peerId, arg.data);
-				}
-				else if constexpr (std::is_same_v<T, IncomingEvent::DisconnectEvent>)
-				{
-					onDisconnection(inEvent.peerId, arg.data);
-				}
-				else if constexpr (std::is_same_v<T, IncomingEvent::PacketEvent>)
-				{
-					onData(inEvent.peerId, std::move(arg.packet));
-				}
-				else if constexpr (std::is_same_v<T, PeerInfo>)
-				{
-					onInfo(inEvent.peerId, arg);
-				}
-				else
-					static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+			for (std::size_t i = 0; i < eventCount; ++i)
+			{
+				IncomingEvent& inEvent = m_pollEvents[i];
 
-			}, inEvent.data);
+				std::visit([&](auto&& arg) {
+					using T = std::decay_t<decltype(arg)>;
+					if constexpr (std::is_same_v<T, IncomingEvent::ConnectEvent>)
+					{
+						onConnection(arg.outgoingConnection, inEvent.peerId, arg.data);
+					}
+					else if constexpr (std::is_same_v<T, IncomingEvent::DisconnectEvent>)
+					{
+						onDisconnection(inEvent.peerId, arg.data);
+					}
+					else if constexpr (std::is_same_v<T, IncomingEvent::PacketEvent>)
+					{
+						onData(inEvent.peerId, std::move(arg.packet));
+					}
+					else if constexpr (std::is_same_v<T, PeerInfo>)
+					{
+						onInfo(inEvent.peerId, arg);
+					}
+					else
+						static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+
+				}, inEvent.data);
+			}
+
+			totalCount += eventCount;
 		}
+
+		if (totalCount > m_peakIncomingCount.load(std::memory_order_relaxed))
+			m_peakIncomingCount.store(totalCount, std::memory_order_relaxed);
 	}
 
 	inline Nz::NetProtocol NetworkReactor::GetProtocol() const
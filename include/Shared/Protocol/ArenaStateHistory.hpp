@@ -0,0 +1,57 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_ARENASTATEHISTORY_HPP
+#define EREWHON_SHARED_NETWORK_ARENASTATEHISTORY_HPP
+
+#include <Shared/Protocol/Packets.hpp>
+#include <array>
+#include <vector>
+
+namespace ewn
+{
+	// Keeps the last arena states sent/received, used as baselines for delta compression
+	class ArenaStateHistory
+	{
+		public:
+			inline ArenaStateHistory();
+			~ArenaStateHistory() = default;
+
+			inline void Clear();
+
+			Nz::UInt8 ComputeChangedFields(Nz::UInt16 baselineId, const Packets::ArenaState::Entity& entity) const;
+			template<typename F> void ComputeRemovedEntities(Nz::UInt16 baselineId, F&& isRemoved, std::vector<CompressedUnsigned<Nz::UInt32>>& removedEntities) const;
+
+			inline bool HasState(Nz::UInt16 stateId) const;
+
+			void RegisterState(const Packets::ArenaState& state);
+
+			bool ResolveDelta(Packets::ArenaState& state) const;
+
+			static std::size_t ComputeEntitySize(const Packets::ArenaState::Entity& entity);
+			static std::size_t ComputeIdSize(Nz::UInt32 entityId);
+
+			static constexpr std::size_t Capacity = 32;
+			static constexpr std::size_t MaxHeaderSize = 2 * sizeof(Nz::UInt16) + 10 + 2 * 5 + sizeof(Nz::UInt64); //< With the largest compressed integers
+
+		private:
+			struct State
+			{
+				bool isValid = false;
+				Nz::UInt16 stateId;
+				std::vector<Packets::ArenaState::Entity> entities; //< Every entity of the resolved state, sorted by id
+			};
+
+			inline const State* GetState(Nz::UInt16 stateId) const;
+
+			std::array<State, Capacity> m_states;
+			std::vector<Packets::ArenaState::Entity> m_mergedEntities;
+	};
+}
+
+#include <Shared/Protocol/ArenaStateHistory.inl>
+
+#endif // EREWHON_SHARED_NETWORK_ARENASTATEHISTORY_HPP
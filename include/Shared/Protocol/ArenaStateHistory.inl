@@ -0,0 +1,53 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/ArenaStateHistory.hpp>
+
+namespace ewn
+{
+	inline ArenaStateHistory::ArenaStateHistory()
+	{
+		Clear();
+	}
+
+	inline void ArenaStateHistory::Clear()
+	{
+		for (State& state : m_states)
+		{
+			state.isValid = false;
+			state.entities.clear();
+		}
+	}
+
+	// Lists baseline entities for which isRemoved(entityId) returns true
+	template<typename F>
+	void ArenaStateHistory::ComputeRemovedEntities(Nz::UInt16 baselineId, F&& isRemoved, std::vector<CompressedUnsigned<Nz::UInt32>>& removedEntities) const
+	{
+		removedEntities.clear();
+
+		const State* baseline = GetState(baselineId);
+		if (!baseline)
+			return;
+
+		for (const Packets::ArenaState::Entity& entity : baseline->entities)
+		{
+			if (isRemoved(Nz::UInt32(entity.id)))
+				removedEntities.emplace_back(entity.id);
+		}
+	}
+
+	inline bool ArenaStateHistory::HasState(Nz::UInt16 stateId) const
+	{
+		return GetState(stateId) != nullptr;
+	}
+
+	inline auto ArenaStateHistory::GetState(Nz::UInt16 stateId) const -> const State*
+	{
+		const State& state = m_states[stateId % Capacity];
+		if (!state.isValid || state.stateId != stateId)
+			return nullptr;
+
+		return &state;
+	}
+}
@@ -10,6 +10,7 @@
 #include <Shared/Enums.hpp>
 #include <Shared/Protocol/CompressedInteger.hpp>
 #include <Shared/Protocol/PacketSerializer.hpp>
+#include <Shared/Protocol/QuantizedTypes.hpp>
 #include <Nazara/Prerequisites.hpp>
 #include <Nazara/Core/String.hpp>
 #include <Nazara/Math/Quaternion.hpp>
@@ -28,6 +29,7 @@ namespace ewn
 		ArenaPrefabs,
 		ArenaSounds,
 		ArenaState,
+		ArenaStateAck,
 		BotMessage,
 		ChatMessage,
 		ControlEntity,
@@ -157,19 +159,37 @@ namespace ewn
 
 		DeclarePacket(ArenaState)
 		{
+			enum EntityField : Nz::UInt8
+			{
+				EntityField_AngularVelocity = 1 << 0,
+				EntityField_LinearVelocity  = 1 << 1,
+				EntityField_Position        = 1 << 2,
+				EntityField_Rotation        = 1 << 3,
+
+				EntityField_All = EntityField_AngularVelocity | EntityField_LinearVelocity | EntityField_Position | EntityField_Rotation
+			};
+
 			struct Entity
 			{
 				CompressedUnsigned<Nz::UInt32> id;
-				Nz::Vector3f angularVelocity;
-				Nz::Vector3f linearVelocity;
-				Nz::Vector3f position;
-				Nz::Quaternionf rotation;
+				Nz::UInt8 fields = EntityField_All; //< Fields sent in this state, others are taken from the baseline
+				QuantizedAngularVelocity angularVelocity;
+				QuantizedLinearVelocity linearVelocity;
+				QuantizedPosition position;
+				QuantizedQuaternion rotation;
 			};
 
 			Nz::UInt16 stateId;
+			Nz::UInt16 baselineId; //< Equal to stateId if this state is not delta-compressed
 			CompressedUnsigned<Nz::UInt64> serverTime;
-			CompressedUnsigned<Nz::UInt64> lastProcessedInputTime;
-			std::vector<Entity> entities;
+			std::vector<Entity> entities; //< Baseline entities not listed here are unchanged
+			std::vector<CompressedUnsigned<Nz::UInt32>> removedEntities; //< Baseline entities which are no longer part of the state
+			Nz::UInt64 lastProcessedInputTime;
+		};
+
+		DeclarePacket(ArenaStateAck)
+		{
+			Nz::UInt16 stateId;
 		};
 
 		DeclarePacket(BotMessage)
@@ -186,16 +206,17 @@ namespace ewn
 		DeclarePacket(ControlEntity)
 		{
 			CompressedUnsigned<Nz::UInt32> id;
+			Nz::Vector3f inertia; //< Principal moments of inertia, in local space (used for prediction)
 		};
 
 		DeclarePacket(CreateEntity)
 		{
 			CompressedUnsigned<Nz::UInt32> entityId;
 			CompressedUnsigned<Nz::UInt32> prefabId;
-			Nz::Quaternionf rotation;
-			Nz::Vector3f angularVelocity;
-			Nz::Vector3f linearVelocity;
-			Nz::Vector3f position;
+			QuantizedQuaternion rotation;
+			QuantizedAngularVelocity angularVelocity;
+			QuantizedLinearVelocity linearVelocity;
+			QuantizedPosition position;
 			Nz::String visualName;
 		};
 
@@ -335,9 +356,17 @@ namespace ewn
 
 		DeclarePacket(PlayerMovement)
 		{
-			CompressedUnsigned<Nz::UInt64> inputTime; //< Server time
-			Nz::Vector3f direction;
-			Nz::Vector3f rotation;
+			struct Input
+			{
+				CompressedUnsigned<Nz::UInt32> timeOffset; //< Milliseconds between this input and inputTime
+				QuantizedInput direction;
+				QuantizedInput rotation;
+			};
+
+			CompressedUnsigned<Nz::UInt64> inputTime; //< Server time of the most recent input
+			std::vector<Input> inputs; //< Most recent first, previous inputs are repeated in case a packet was lost
+
+			static constexpr std::size_t MaxInputCount = 6;
 		};
 
 		DeclarePacket(PlayerShoot)
@@ -452,6 +481,7 @@ namespace ewn
 		void Serialize(PacketSerializer& serializer, ArenaParticleSystems& data);
 		void Serialize(PacketSerializer& serializer, ArenaSounds& data);
 		void Serialize(PacketSerializer& serializer, ArenaState& data);
+		void Serialize(PacketSerializer& serializer, ArenaStateAck& data);
 		void Serialize(PacketSerializer& serializer, BotMessage& data);
 		void Serialize(PacketSerializer& serializer, ChatMessage& data);
 		void Serialize(PacketSerializer& serializer, ControlEntity& data);
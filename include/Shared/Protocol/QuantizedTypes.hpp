@@ -0,0 +1,93 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_QUANTIZEDTYPES_HPP
+#define EREWHON_SHARED_NETWORK_QUANTIZEDTYPES_HPP
+
+#include <Nazara/Core/Algorithm.hpp>
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+
+namespace ewn
+{
+	// Fixed-point vector, each component is clamped to [-Range, Range] and stored on Bits bits (zero is exactly representable)
+	template<unsigned int Bits, unsigned int Range>
+	class QuantizedVector3
+	{
+		static_assert(Bits >= 2 && Bits <= 21, "Components must fit in a 64 bits integer");
+
+		public:
+			explicit QuantizedVector3(const Nz::Vector3f& value = Nz::Vector3f::Zero());
+			~QuantizedVector3() = default;
+
+			Nz::UInt64 GetPackedValue() const;
+
+			void SetPackedValue(Nz::UInt64 packedValue);
+
+			operator Nz::Vector3f() const;
+
+			QuantizedVector3& operator=(const Nz::Vector3f& value);
+
+			bool operator==(const QuantizedVector3& other) const;
+			bool operator!=(const QuantizedVector3& other) const;
+
+			static constexpr std::size_t ByteSize = (3 * Bits + 7) / 8;
+
+		private:
+			static constexpr Nz::Int32 MaxValue = (1 << (Bits - 1)) - 1;
+
+			Nz::UInt64 m_packedValue;
+	};
+
+	// Smallest-three quaternion: index of the largest component on 2 bits and the three others on 10 bits each
+	class QuantizedQuaternion
+	{
+		public:
+			explicit QuantizedQuaternion(const Nz::Quaternionf& value = Nz::Quaternionf::Identity());
+			~QuantizedQuaternion() = default;
+
+			inline Nz::UInt32 GetPackedValue() const;
+
+			inline void SetPackedValue(Nz::UInt32 packedValue);
+
+			operator Nz::Quaternionf() const;
+
+			QuantizedQuaternion& operator=(const Nz::Quaternionf& value);
+
+			inline bool operator==(const QuantizedQuaternion& other) const;
+			inline bool operator!=(const QuantizedQuaternion& other) const;
+
+			static constexpr std::size_t ByteSize = 4;
+
+		private:
+			static constexpr unsigned int ComponentBits = 10;
+			static constexpr Nz::Int32 MaxValue = (1 << (ComponentBits - 1)) - 1;
+
+			Nz::UInt32 m_packedValue;
+	};
+
+	using QuantizedAngularVelocity = QuantizedVector3<10, 8>;   //< 4 bytes, ~0.016 rad/s precision
+	using QuantizedInput = QuantizedVector3<8, 1>;              //< 3 bytes, player inputs are clamped to [-1, 1]
+	using QuantizedLinearVelocity = QuantizedVector3<13, 256>;  //< 5 bytes, ~0.06 m/s precision
+	using QuantizedPosition = QuantizedVector3<21, 4096>;       //< 8 bytes, ~4mm precision inside arena extents
+
+	// Half-size of an arena, the server keeps every entity inside it so positions never get clamped on the wire
+	constexpr float ArenaExtent = 4000.f;
+
+	static_assert(ArenaExtent <= 4096.f, "Arena extent must fit in QuantizedPosition range");
+}
+
+namespace Nz
+{
+	template<unsigned int Bits, unsigned int Range> bool Serialize(SerializationContext& context, const ewn::QuantizedVector3<Bits, Range>& value, TypeTag<ewn::QuantizedVector3<Bits, Range>>);
+	inline bool Serialize(SerializationContext& context, const ewn::QuantizedQuaternion& value, TypeTag<ewn::QuantizedQuaternion>);
+	template<unsigned int Bits, unsigned int Range> bool Unserialize(SerializationContext& context, ewn::QuantizedVector3<Bits, Range>* value, TypeTag<ewn::QuantizedVector3<Bits, Range>>);
+	inline bool Unserialize(SerializationContext& context, ewn::QuantizedQuaternion* value, TypeTag<ewn::QuantizedQuaternion>);
+}
+
+#include <Shared/Protocol/QuantizedTypes.inl>
+
+#endif // EREWHON_SHARED_NETWORK_QUANTIZEDTYPES_HPP
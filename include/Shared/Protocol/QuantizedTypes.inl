@@ -0,0 +1,144 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/QuantizedTypes.hpp>
+#include <cmath>
+
+namespace ewn
+{
+	template<unsigned int Bits, unsigned int Range>
+	QuantizedVector3<Bits, Range>::QuantizedVector3(const Nz::Vector3f& value)
+	{
+		operator=(value);
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	Nz::UInt64 QuantizedVector3<Bits, Range>::GetPackedValue() const
+	{
+		return m_packedValue;
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	void QuantizedVector3<Bits, Range>::SetPackedValue(Nz::UInt64 packedValue)
+	{
+		constexpr Nz::UInt64 packedMask = (Nz::UInt64(1) << (3 * Bits)) - 1;
+
+		m_packedValue = packedValue & packedMask;
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	QuantizedVector3<Bits, Range>::operator Nz::Vector3f() const
+	{
+		constexpr Nz::UInt64 componentMask = (Nz::UInt64(1) << Bits) - 1;
+		constexpr float invScale = float(Range) / MaxValue;
+
+		auto Decode = [&](unsigned int index)
+		{
+			Nz::Int32 quantized = static_cast<Nz::Int32>((m_packedValue >> (index * Bits)) & componentMask) - MaxValue;
+			return quantized * invScale;
+		};
+
+		return Nz::Vector3f(Decode(0), Decode(1), Decode(2));
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	QuantizedVector3<Bits, Range>& QuantizedVector3<Bits, Range>::operator=(const Nz::Vector3f& value)
+	{
+		constexpr float scale = MaxValue / float(Range);
+
+		auto Encode = [&](float component)
+		{
+			if (!std::isfinite(component))
+				component = 0.f;
+
+			component = Nz::Clamp(component, -float(Range), float(Range));
+			return static_cast<Nz::UInt64>(std::lround(component * scale) + MaxValue);
+		};
+
+		m_packedValue = Encode(value.x) | (Encode(value.y) << Bits) | (Encode(value.z) << (2 * Bits));
+		return *this;
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	bool QuantizedVector3<Bits, Range>::operator==(const QuantizedVector3& other) const
+	{
+		return m_packedValue == other.m_packedValue;
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	bool QuantizedVector3<Bits, Range>::operator!=(const QuantizedVector3& other) const
+	{
+		return !operator==(other);
+	}
+
+
+	inline Nz::UInt32 QuantizedQuaternion::GetPackedValue() const
+	{
+		return m_packedValue;
+	}
+
+	inline void QuantizedQuaternion::SetPackedValue(Nz::UInt32 packedValue)
+	{
+		m_packedValue = packedValue;
+	}
+
+	inline bool QuantizedQuaternion::operator==(const QuantizedQuaternion& other) const
+	{
+		return m_packedValue == other.m_packedValue;
+	}
+
+	inline bool QuantizedQuaternion::operator!=(const QuantizedQuaternion& other) const
+	{
+		return !operator==(other);
+	}
+}
+
+namespace Nz
+{
+	template<unsigned int Bits, unsigned int Range>
+	bool Serialize(SerializationContext& context, const ewn::QuantizedVector3<Bits, Range>& value, TypeTag<ewn::QuantizedVector3<Bits, Range>>)
+	{
+		// Only write the bytes we need, in little-endian order
+		Nz::UInt64 packedValue = value.GetPackedValue();
+		for (std::size_t i = 0; i < ewn::QuantizedVector3<Bits, Range>::ByteSize; ++i)
+		{
+			if (!Serialize(context, static_cast<Nz::UInt8>(packedValue >> (i * 8))))
+				return false;
+		}
+
+		return true;
+	}
+
+	inline bool Serialize(SerializationContext& context, const ewn::QuantizedQuaternion& value, TypeTag<ewn::QuantizedQuaternion>)
+	{
+		return Serialize(context, value.GetPackedValue());
+	}
+
+	template<unsigned int Bits, unsigned int Range>
+	bool Unserialize(SerializationContext& context, ewn::QuantizedVector3<Bits, Range>* value, TypeTag<ewn::QuantizedVector3<Bits, Range>>)
+	{
+		Nz::UInt64 packedValue = 0;
+		for (std::size_t i = 0; i < ewn::QuantizedVector3<Bits, Range>::ByteSize; ++i)
+		{
+			Nz::UInt8 byteValue;
+			if (!Unserialize(context, &byteValue))
+				return false;
+
+			packedValue |= Nz::UInt64(byteValue) << (i * 8);
+		}
+
+		value->SetPackedValue(packedValue);
+		return true;
+	}
+
+	inline bool Unserialize(SerializationContext& context, ewn::QuantizedQuaternion* value, TypeTag<ewn::QuantizedQuaternion>)
+	{
+		Nz::UInt32 packedValue;
+		if (!Unserialize(context, &packedValue))
+			return false;
+
+		value->SetPackedValue(packedValue);
+		return true;
+	}
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_SPACESHIPMOVEMENT_HPP
+#define EREWHON_SHARED_SPACESHIPMOVEMENT_HPP
+
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+
+namespace ewn
+{
+	// How player inputs move a spaceship, shared by the server InputSystem and client-side prediction
+	class SpaceshipMovement
+	{
+		public:
+			struct State;
+
+			SpaceshipMovement() = delete;
+			~SpaceshipMovement() = delete;
+
+			static void ApplyInput(State& state, const Nz::Vector3f& inertia, float inputElapsedTime, const Nz::Vector3f& movement, const Nz::Vector3f& rotation);
+
+			static inline Nz::Vector3f ComputeForce(float inputElapsedTime, const Nz::Vector3f& movement);
+			static inline Nz::Vector3f ComputeTorque(float inputElapsedTime, const Nz::Vector3f& rotation);
+
+			static void Integrate(State& state, float elapsedTime);
+
+			static constexpr float AngularDamping = 0.4f;
+			static constexpr float AngularMultiplier = 3000.f;
+			static constexpr float ForceMultiplier = 15000.f;
+			static constexpr float LinearDamping = 0.25f;
+			static constexpr float Mass = 42.f;
+			static constexpr float MovementScale = 50.f;
+			static constexpr float RotationScale = 200.f;
+
+			// Forces are only applied for one step of the server physics world (Nz::PhysWorld3D default step size)
+			static constexpr float PhysicsStepSize = 0.005f;
+
+			// Newton damping coefficients are given per 1/60s
+			static constexpr float DampingRate = 60.f;
+
+			struct State
+			{
+				Nz::Quaternionf rotation;
+				Nz::Vector3f angularVelocity;
+				Nz::Vector3f linearVelocity;
+				Nz::Vector3f position;
+			};
+	};
+}
+
+#include <Shared/SpaceshipMovement.inl>
+
+#endif // EREWHON_SHARED_SPACESHIPMOVEMENT_HPP
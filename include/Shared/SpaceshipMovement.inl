@@ -0,0 +1,20 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/SpaceshipMovement.hpp>
+
+namespace ewn
+{
+	// Force in spaceship local space, movement is expected to be scaled by MovementScale already
+	inline Nz::Vector3f SpaceshipMovement::ComputeForce(float inputElapsedTime, const Nz::Vector3f& movement)
+	{
+		return ForceMultiplier * inputElapsedTime * movement;
+	}
+
+	// Torque in global space, rotation is expected to be scaled by RotationScale already
+	inline Nz::Vector3f SpaceshipMovement::ComputeTorque(float inputElapsedTime, const Nz::Vector3f& rotation)
+	{
+		return AngularMultiplier * inputElapsedTime * rotation;
+	}
+}
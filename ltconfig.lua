@@ -0,0 +1,15 @@
+dofile("cconfig.lua")
+
+LoadTest = {
+	ArenaIndex       = 0,
+	ClientCount      = 50,
+	ConnectionRate   = 10, -- Clients connecting per second
+	Duration         = 0, -- Seconds before disconnecting every client, 0 to run until killed
+	LoginPrefix      = "loadbot",
+	MovementRate     = 60, -- Movement packets per second and per client, same as the real client
+	Password         = "loadtest",
+	ReportInterval   = 5,
+	SpawnedBotCount  = 0, -- Bots spawned by each client using ServerScript.Filename, in [0, 10]
+	SpaceshipName    = "loadbot",
+	TimeSyncInterval = 1 -- Seconds between two latency samples
+}
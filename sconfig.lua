@@ -10,9 +10,13 @@ Database = {
 }
 
 Game = {
-	MaxClients  = 100,
-	Port        = 2050,
-	WorkerCount = 2
+	InterestRadius  = 1000, -- Moving entities further than this from a player spaceship are not sent to them
+	MaxCatchUpTicks = 5, -- Ticks run in a row when late, remaining ones are skipped
+	MaxClients      = 100,
+	Port            = 2050,
+	ReactorCount    = 2, -- Network threads, each one listens on its own port starting from Port
+	TickRate        = 60,
+	WorkerCount     = 2
 }
 
 -- Warning: changing these parameters will break login to already registered accounts
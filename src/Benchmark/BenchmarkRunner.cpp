@@ -0,0 +1,72 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/BenchmarkRunner.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <iomanip>
+#include <iostream>
+
+namespace ewn
+{
+	namespace
+	{
+		volatile std::size_t s_sink;
+	}
+
+	void BenchmarkRunner::Run(const std::string& name, const Function& function, const Function& setup)
+	{
+		if (!IsEnabled(name))
+			return;
+
+		// Warm caches and lazy initializations up
+		if (setup)
+			setup();
+
+		function();
+
+		// Double iteration count until a run lasts long enough to be meaningful
+		std::size_t iterationCount = 1;
+		Nz::UInt64 elapsedTime;
+		for (;;)
+		{
+			Nz::Clock clock;
+			if (setup)
+			{
+				// Setup runs before every iteration, outside of the measured time
+				clock.Pause();
+				for (std::size_t i = 0; i < iterationCount; ++i)
+				{
+					setup();
+
+					clock.Unpause();
+					function();
+					clock.Pause();
+				}
+			}
+			else
+			{
+				for (std::size_t i = 0; i < iterationCount; ++i)
+					function();
+			}
+
+			elapsedTime = clock.GetMicroseconds();
+			if (elapsedTime >= m_minDuration)
+				break;
+
+			iterationCount *= 2;
+		}
+
+		double nsPerIteration = elapsedTime * 1000.0 / iterationCount;
+
+		std::cout << std::left << std::setw(48) << name << std::right;
+		std::cout << std::setw(12) << std::fixed << std::setprecision(1) << nsPerIteration << " ns/op";
+		std::cout << std::setw(12) << iterationCount << " iterations" << std::endl;
+	}
+
+	void BenchmarkRunner::Consume(std::size_t value)
+	{
+		// Keep the compiler from optimizing benchmarked code away
+		s_sink = value;
+	}
+}
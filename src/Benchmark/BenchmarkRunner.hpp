@@ -0,0 +1,43 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_BENCHMARK_BENCHMARKRUNNER_HPP
+#define EREWHON_BENCHMARK_BENCHMARKRUNNER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <functional>
+#include <string>
+
+namespace ewn
+{
+	class BenchmarkRunner
+	{
+		public:
+			using Function = std::function<void()>;
+
+			inline BenchmarkRunner(std::string filter, Nz::UInt64 minDuration);
+			BenchmarkRunner(const BenchmarkRunner&) = delete;
+			BenchmarkRunner(BenchmarkRunner&&) = delete;
+			~BenchmarkRunner() = default;
+
+			inline bool IsEnabled(const std::string& name) const;
+
+			void Run(const std::string& name, const Function& function, const Function& setup = Function());
+
+			BenchmarkRunner& operator=(const BenchmarkRunner&) = delete;
+			BenchmarkRunner& operator=(BenchmarkRunner&&) = delete;
+
+			static void Consume(std::size_t value);
+
+		private:
+			std::string m_filter;
+			Nz::UInt64 m_minDuration; //< Microseconds
+	};
+}
+
+#include <Benchmark/BenchmarkRunner.inl>
+
+#endif // EREWHON_BENCHMARK_BENCHMARKRUNNER_HPP
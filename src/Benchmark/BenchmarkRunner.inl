@@ -0,0 +1,19 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/BenchmarkRunner.hpp>
+
+namespace ewn
+{
+	inline BenchmarkRunner::BenchmarkRunner(std::string filter, Nz::UInt64 minDuration) :
+	m_filter(std::move(filter)),
+	m_minDuration(minDuration)
+	{
+	}
+
+	inline bool BenchmarkRunner::IsEnabled(const std::string& name) const
+	{
+		return m_filter.empty() || name.find(m_filter) != std::string::npos;
+	}
+}
@@ -0,0 +1,21 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_BENCHMARK_BENCHMARKS_HPP
+#define EREWHON_BENCHMARK_BENCHMARKS_HPP
+
+namespace ewn
+{
+	class BenchmarkRunner;
+	class ServerApplication;
+
+	void RunBroadcastBenchmarks(BenchmarkRunner& runner, ServerApplication& app);
+	void RunProtocolBenchmarks(BenchmarkRunner& runner);
+	void RunRadarBenchmarks(BenchmarkRunner& runner);
+	void RunScriptBenchmarks(BenchmarkRunner& runner, ServerApplication& app);
+}
+
+#endif // EREWHON_BENCHMARK_BENCHMARKS_HPP
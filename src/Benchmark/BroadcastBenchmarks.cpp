@@ -0,0 +1,86 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmarks.hpp>
+#include <Benchmark/BenchmarkRunner.hpp>
+#include <NDK/World.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Server/Player.hpp>
+#include <Server/ServerApplication.hpp>
+#include <Server/Components/SynchronizedComponent.hpp>
+#include <Server/Systems/BroadcastSystem.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
+#include <memory>
+#include <random>
+
+namespace ewn
+{
+	void RunBroadcastBenchmarks(BenchmarkRunner& runner, ServerApplication& app)
+	{
+		constexpr float ArenaSize = 4000.f;
+
+		// Players need a reactor, nothing is sent through it as no arena is listening to broadcast signals
+		NetworkReactor reactor(0, Nz::NetProtocol_IPv4, 0, 1);
+
+		for (std::size_t entityCount : { 100, 1000, 5000 })
+		{
+			for (std::size_t playerCount : { 1, 16 })
+			{
+				std::string name = "Broadcast/OnUpdate (" + std::to_string(entityCount) + " entities, " + std::to_string(playerCount) + " players)";
+				if (!runner.IsEnabled(name))
+					continue;
+
+				std::mt19937 randomGenerator(42);
+				std::uniform_real_distribution<float> positionDis(-ArenaSize / 2.f, ArenaSize / 2.f);
+
+				Ndk::World world;
+				auto& broadcastSystem = world.AddSystem<BroadcastSystem>(&app);
+				broadcastSystem.SetMaximumUpdateRate(0.f);
+
+				auto& spatialSystem = world.AddSystem<SpatialSystem>();
+				spatialSystem.SetMaximumUpdateRate(0.f);
+
+				for (std::size_t i = 0; i < entityCount; ++i)
+				{
+					Nz::Vector3f position(positionDis(randomGenerator), positionDis(randomGenerator), positionDis(randomGenerator));
+
+					const Ndk::EntityHandle& entity = world.CreateEntity();
+					entity->AddComponent<Ndk::NodeComponent>().SetPosition(position);
+					entity->AddComponent<SynchronizedComponent>(4, "ball", "", true, 3);
+					entity->AddComponent<Ndk::PhysicsComponent3D>().SetPosition(position);
+				}
+
+				world.Refresh();
+
+				// Entities don't move, the grid only has to be built once
+				spatialSystem.Update(1.f / 30.f);
+
+				std::vector<std::unique_ptr<Player>> players;
+				for (std::size_t i = 0; i < playerCount; ++i)
+				{
+					auto& player = players.emplace_back(std::make_unique<Player>(&app, i, i, reactor, app.GetCommandStore()));
+					broadcastSystem.AddPlayer(player.get());
+				}
+
+				std::size_t sentEntityCount = 0;
+				broadcastSystem.BroadcastStateUpdate.Connect([&](const BroadcastSystem*, Player*, Packets::ArenaState& statePacket)
+				{
+					sentEntityCount += statePacket.entities.size();
+				});
+
+				// First updates stream entity creations in, following ones measure the steady state
+				runner.Run(name, [&]()
+				{
+					broadcastSystem.Update(1.f / 30.f);
+				});
+
+				BenchmarkRunner::Consume(sentEntityCount);
+
+				for (const auto& player : players)
+					broadcastSystem.RemovePlayer(player.get());
+			}
+		}
+	}
+}
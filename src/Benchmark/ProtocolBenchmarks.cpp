@@ -0,0 +1,158 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmarks.hpp>
+#include <Benchmark/BenchmarkRunner.hpp>
+#include <Nazara/Math/EulerAngles.hpp>
+#include <Shared/CommandStore.hpp>
+#include <Shared/Protocol/CompressedInteger.hpp>
+#include <Shared/Protocol/PacketSerializer.hpp>
+#include <random>
+
+namespace ewn
+{
+	namespace
+	{
+		class BenchmarkCommandStore : public CommandStore
+		{
+			public:
+				BenchmarkCommandStore()
+				{
+					RegisterIncomingCommand<Packets::ArenaStateAck>("ArenaStateAck", [](std::size_t /*peerId*/, const Packets::ArenaStateAck& data) { BenchmarkRunner::Consume(data.stateId); });
+					RegisterIncomingCommand<Packets::PlayerMovement>("PlayerMovement", [](std::size_t /*peerId*/, const Packets::PlayerMovement& data) { BenchmarkRunner::Consume(data.inputTime); });
+
+					RegisterOutgoingCommand<Packets::ArenaState>("ArenaState", 0, 0);
+					RegisterOutgoingCommand<Packets::ArenaStateAck>("ArenaStateAck", 0, 0);
+					RegisterOutgoingCommand<Packets::CreateEntity>("CreateEntity", 0, 0);
+					RegisterOutgoingCommand<Packets::PlayerMovement>("PlayerMovement", 0, 0);
+				}
+		};
+
+		Packets::ArenaState BuildArenaState(std::mt19937& randomGenerator, std::size_t entityCount)
+		{
+			std::uniform_real_distribution<float> positionDis(-1000.f, 1000.f);
+			std::uniform_real_distribution<float> velocityDis(-50.f, 50.f);
+
+			Packets::ArenaState arenaState;
+			arenaState.stateId = 42;
+			arenaState.baselineId = 42;
+			arenaState.serverTime = 123'456'789;
+			arenaState.lastProcessedInputTime = 123'456'000;
+
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				auto& entity = arenaState.entities.emplace_back();
+				entity.id = Nz::UInt32(i * 7);
+				entity.angularVelocity = Nz::Vector3f(velocityDis(randomGenerator), velocityDis(randomGenerator), velocityDis(randomGenerator)) / 50.f;
+				entity.linearVelocity = Nz::Vector3f(velocityDis(randomGenerator), velocityDis(randomGenerator), velocityDis(randomGenerator));
+				entity.position = Nz::Vector3f(positionDis(randomGenerator), positionDis(randomGenerator), positionDis(randomGenerator));
+				entity.rotation = Nz::EulerAnglesf(velocityDis(randomGenerator), velocityDis(randomGenerator), velocityDis(randomGenerator)).ToQuaternion();
+			}
+
+			return arenaState;
+		}
+
+		Packets::CreateEntity BuildCreateEntity()
+		{
+			Packets::CreateEntity createEntity;
+			createEntity.entityId = 1234;
+			createEntity.prefabId = 4;
+			createEntity.angularVelocity = Nz::Vector3f(0.1f, 0.2f, 0.3f);
+			createEntity.linearVelocity = Nz::Vector3f(10.f, -5.f, 2.5f);
+			createEntity.position = Nz::Vector3f(150.f, -42.f, 800.f);
+			createEntity.rotation = Nz::EulerAnglesf(10.f, 20.f, 30.f).ToQuaternion();
+			createEntity.visualName = "Some spaceship name";
+
+			return createEntity;
+		}
+
+		inline Nz::NetPacket ToReceivedPacket(const Nz::NetPacket& packet)
+		{
+			// Copy the payload like ENet does, reading starts at its beginning
+			return Nz::NetPacket(packet.GetNetCode(), static_cast<const Nz::UInt8*>(packet.GetConstData()) + Nz::NetPacket::HeaderSize, packet.GetDataSize());
+		}
+
+		template<typename T>
+		void RoundTrip(const CommandStore& commandStore, const T& packet)
+		{
+			Nz::NetPacket outgoing;
+			commandStore.SerializePacket(outgoing, packet);
+
+			Nz::NetPacket incoming = ToReceivedPacket(outgoing);
+
+			Nz::UInt8 opcode;
+			incoming >> opcode;
+
+			T data;
+			PacketSerializer serializer(incoming, false);
+			Packets::Serialize(serializer, data);
+
+			BenchmarkRunner::Consume(opcode + outgoing.GetDataSize());
+		}
+	}
+
+	void RunProtocolBenchmarks(BenchmarkRunner& runner)
+	{
+		std::mt19937 randomGenerator(42);
+
+		BenchmarkCommandStore commandStore;
+
+		// Full ArenaState are bounded by BroadcastSystem to what fits in a single ENet packet (~30 entities)
+		for (std::size_t entityCount : { 1, 10, 30 })
+		{
+			Packets::ArenaState arenaState = BuildArenaState(randomGenerator, entityCount);
+			runner.Run("Protocol/ArenaState round trip (" + std::to_string(entityCount) + " entities)", [&]()
+			{
+				RoundTrip(commandStore, arenaState);
+			});
+		}
+
+		Packets::CreateEntity createEntity = BuildCreateEntity();
+		runner.Run("Protocol/CreateEntity round trip", [&]()
+		{
+			RoundTrip(commandStore, createEntity);
+		});
+
+		// Coalesced messages, as sent by NetworkReactor (a client sending inputs and acknowledging states)
+		for (std::size_t messageCount : { 1, 8, 32 })
+		{
+			Nz::NetPacket batch;
+			for (std::size_t i = 0; i < messageCount; ++i)
+			{
+				Nz::NetPacket message;
+				if (i % 4 == 3)
+				{
+					Packets::ArenaStateAck ack;
+					ack.stateId = Nz::UInt16(i);
+
+					commandStore.SerializePacket(message, ack);
+				}
+				else
+				{
+					// Same redundancy as the client
+					Packets::PlayerMovement movement;
+					movement.inputTime = 123'456'789 + i;
+
+					for (Nz::UInt32 inputIndex = 0; inputIndex < 6; ++inputIndex)
+					{
+						auto& input = movement.inputs.emplace_back();
+						input.timeOffset = inputIndex * 16;
+						input.direction = Nz::Vector3f(0.f, 0.f, 1.f);
+						input.rotation = Nz::Vector3f(0.25f, -0.5f, 0.f);
+					}
+
+					commandStore.SerializePacket(message, movement);
+				}
+
+				batch << CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(message.GetDataSize()));
+				batch.Write(static_cast<const Nz::UInt8*>(message.GetConstData()) + Nz::NetPacket::HeaderSize, message.GetDataSize());
+			}
+
+			runner.Run("Protocol/UnserializePacket (" + std::to_string(messageCount) + " messages)", [&]()
+			{
+				commandStore.UnserializePacket(0, ToReceivedPacket(batch));
+			});
+		}
+	}
+}
@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmarks.hpp>
+#include <Benchmark/BenchmarkRunner.hpp>
+#include <NDK/World.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Server/SpaceshipCore.hpp>
+#include <Server/Components/SignatureComponent.hpp>
+#include <Server/Modules/RadarModule.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
+#include <random>
+
+namespace ewn
+{
+	void RunRadarBenchmarks(BenchmarkRunner& runner)
+	{
+		constexpr float ArenaSize = 4000.f;
+		constexpr float DetectionRadius = 500.f;
+
+		// Density sweep: same volume and radar range, more and more entities to report
+		for (std::size_t entityCount : { 100, 1000, 10000 })
+		{
+			std::string name = "Radar/PerformScan (" + std::to_string(entityCount) + " entities)";
+			if (!runner.IsEnabled(name))
+				continue;
+
+			std::mt19937 randomGenerator(42);
+			std::uniform_real_distribution<float> positionDis(-ArenaSize / 2.f, ArenaSize / 2.f);
+
+			Ndk::World world;
+			world.AddSystem<SpatialSystem>();
+
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				Nz::Vector3f position(positionDis(randomGenerator), positionDis(randomGenerator), positionDis(randomGenerator));
+
+				const Ndk::EntityHandle& entity = world.CreateEntity();
+				entity->AddComponent<Ndk::NodeComponent>().SetPosition(position);
+				entity->AddComponent<Ndk::PhysicsComponent3D>().SetPosition(position);
+				entity->AddComponent<SignatureComponent>(entity->GetId(), 0.0, 10.0, 1000.0);
+			}
+
+			const Ndk::EntityHandle& spaceship = world.CreateEntity();
+			spaceship->AddComponent<Ndk::NodeComponent>();
+			spaceship->AddComponent<Ndk::PhysicsComponent3D>();
+
+			world.Refresh();
+			world.GetSystem<SpatialSystem>().Update(0.f);
+
+			// A new radar reports every entity in range once, build one per iteration to always measure a full scan
+			runner.Run(name, [&]()
+			{
+				SpaceshipCore core(spaceship);
+				RadarModule radar(&core, spaceship, DetectionRadius, 1);
+				radar.Run(0.f);
+
+				BenchmarkRunner::Consume(radar.Scan().size());
+			});
+		}
+	}
+}
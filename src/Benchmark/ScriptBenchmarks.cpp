@@ -0,0 +1,77 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmarks.hpp>
+#include <Benchmark/BenchmarkRunner.hpp>
+#include <NDK/World.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <Server/Components/ScriptComponent.hpp>
+#include <Server/Scripting/ScriptStatePool.hpp>
+#include <iostream>
+
+namespace ewn
+{
+	namespace
+	{
+		const char* s_benchmarkScript = R"(
+Spaceship.ElapsedTime = 0
+
+function Spaceship:OnTick(elapsedTime)
+	self.ElapsedTime = self.ElapsedTime + elapsedTime
+end
+)";
+	}
+
+	void RunScriptBenchmarks(BenchmarkRunner& runner, ServerApplication& app)
+	{
+		Ndk::World world;
+
+		auto CreateScriptedEntity = [&]() -> const Ndk::EntityHandle&
+		{
+			const Ndk::EntityHandle& entity = world.CreateEntity();
+			entity->AddComponent<Ndk::NodeComponent>();
+
+			ScriptComponent& script = entity->AddComponent<ScriptComponent>();
+			script.Initialize(&app, {});
+
+			Nz::String lastError;
+			if (!script.Execute(s_benchmarkScript, &lastError))
+				std::cerr << "Failed to execute benchmark script: " << lastError << std::endl;
+
+			return entity;
+		};
+
+		auto CreateAndKillScriptedEntity = [&]()
+		{
+			CreateScriptedEntity()->Kill();
+			world.Refresh();
+		};
+
+		// Includes destroying the state, which isn't given back to the pool: the pool is refilled outside of the measured time instead
+		runner.Run("Script/ScriptComponent creation (pooled state)", CreateAndKillScriptedEntity, []()
+		{
+			if (ScriptStatePool::GetAvailableCount() == 0)
+				ScriptStatePool::Refill(ScriptStatePool::PoolSize);
+		});
+
+		// Pool kept empty, every creation builds its state from scratch
+		runner.Run("Script/ScriptComponent creation (cold state)", CreateAndKillScriptedEntity, []()
+		{
+			while (ScriptStatePool::GetAvailableCount() > 0)
+				ScriptStatePool::Acquire();
+		});
+
+		ScriptStatePool::Refill(ScriptStatePool::PoolSize);
+
+		const Ndk::EntityHandle& entity = CreateScriptedEntity();
+		ScriptComponent& script = entity->GetComponent<ScriptComponent>();
+
+		// One OnTick callback per run, as the script system does every 0.5s
+		runner.Run("Script/ScriptComponent Run (OnTick)", [&]()
+		{
+			script.Update(0.5f);
+			BenchmarkRunner::Consume(script.Run());
+		});
+	}
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Benchmark" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Benchmark/Benchmarks.hpp>
+#include <Benchmark/BenchmarkRunner.hpp>
+#include <Server/ServerApplication.hpp>
+#include <Server/Components/ArenaComponent.hpp>
+#include <Server/Components/CommunicationComponent.hpp>
+#include <Server/Components/HealthComponent.hpp>
+#include <Server/Components/InputComponent.hpp>
+#include <Server/Components/LifeTimeComponent.hpp>
+#include <Server/Components/NavigationComponent.hpp>
+#include <Server/Components/OwnerComponent.hpp>
+#include <Server/Components/PlayerControlledComponent.hpp>
+#include <Server/Components/ProjectileComponent.hpp>
+#include <Server/Components/ScriptComponent.hpp>
+#include <Server/Components/SignatureComponent.hpp>
+#include <Server/Components/SynchronizedComponent.hpp>
+#include <Server/Scripting/ArenaInterface.hpp>
+#include <Server/Scripting/ScriptStatePool.hpp>
+#include <Server/Systems/ArenaBoundsSystem.hpp>
+#include <Server/Systems/BroadcastSystem.hpp>
+#include <Server/Systems/LifeTimeSystem.hpp>
+#include <Server/Systems/NavigationSystem.hpp>
+#include <Server/Systems/ScriptSystem.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
+#include <Server/Systems/InputSystem.hpp>
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <NDK/Sdk.hpp>
+#include <iostream>
+#include <string>
+
+// Usage: ErewhonBenchmark [filter] [min duration per benchmark in ms]
+int main(int argc, char* argv[])
+{
+	Nz::Initializer<Nz::Network, Ndk::Sdk> nazara; //< Init SDK before application because of custom components/systems
+
+	Nz::Initializer<ewn::ArenaInterface, ewn::ScriptStatePool> binding;
+	if (!binding)
+	{
+		std::cerr << "Failed to initialize scripting" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Same registration as the server
+	Ndk::InitializeComponent<ewn::ArenaComponent>("Arena");
+	Ndk::InitializeComponent<ewn::CommunicationComponent>("ComComp");
+	Ndk::InitializeComponent<ewn::HealthComponent>("Health");
+	Ndk::InitializeComponent<ewn::LifeTimeComponent>("LifeTime");
+	Ndk::InitializeComponent<ewn::InputComponent>("InptComp");
+	Ndk::InitializeComponent<ewn::NavigationComponent>("NavigCmp");
+	Ndk::InitializeComponent<ewn::OwnerComponent>("OwnrComp");
+	Ndk::InitializeComponent<ewn::PlayerControlledComponent>("PlyCtrl");
+	Ndk::InitializeComponent<ewn::ProjectileComponent>("Prjctile");
+	Ndk::InitializeComponent<ewn::ScriptComponent>("ScrptCmp");
+	Ndk::InitializeComponent<ewn::SignatureComponent>("SignCmp");
+	Ndk::InitializeComponent<ewn::SynchronizedComponent>("SyncComp");
+	Ndk::InitializeSystem<ewn::ArenaBoundsSystem>();
+	Ndk::InitializeSystem<ewn::BroadcastSystem>();
+	Ndk::InitializeSystem<ewn::LifeTimeSystem>();
+	Ndk::InitializeSystem<ewn::NavigationSystem>();
+	Ndk::InitializeSystem<ewn::ScriptSystem>();
+	Ndk::InitializeSystem<ewn::SpatialSystem>();
+	Ndk::InitializeSystem<ewn::InputSystem>();
+
+	std::string filter = (argc > 1) ? argv[1] : "";
+	Nz::UInt64 minDuration = (argc > 2) ? std::stoull(argv[2]) * 1000 : 500'000;
+
+	// No database nor network is set up, benchmarks only use the application for its stores and command store
+	ewn::ServerApplication app;
+
+	ewn::BenchmarkRunner runner(std::move(filter), minDuration);
+	ewn::RunProtocolBenchmarks(runner);
+	ewn::RunBroadcastBenchmarks(runner, app);
+	ewn::RunRadarBenchmarks(runner);
+	ewn::RunScriptBenchmarks(runner, app);
+}
@@ -7,10 +7,12 @@
 #include <Shared/Config.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <iostream>
+#include <random>
 
 namespace ewn
 {
-	ClientApplication::ClientApplication()
+	ClientApplication::ClientApplication(std::size_t maxServerCount) :
+	m_maxServerCount(maxServerCount)
 	{
 		RegisterConfig();
 	}
@@ -24,14 +26,38 @@ namespace ewn
 
 	bool ClientApplication::ConnectNewServer(const Nz::String& serverHostname, Nz::UInt32 data, ServerConnection* connection, std::size_t* peerId, NetworkReactor** peerReactor)
 	{
-		constexpr std::size_t MaxPeerCount = 1;
+		Nz::UInt16 portCount = m_config.GetIntegerOption<Nz::UInt16>("Server.PortCount");
 
-		Nz::UInt16 port = m_config.GetIntegerOption<Nz::UInt16>("Server.Port");
+		ConnectionAttempt attempt;
+		attempt.data = data;
+		attempt.firstPortIndex = 0;
+		attempt.hostname = serverHostname;
+		attempt.triedPortCount = 0;
+
+		// Server spreads its clients over one network reactor per port, start with a random one
+		if (portCount > 1)
+		{
+			std::random_device randomDevice;
+			std::uniform_int_distribution<Nz::UInt16> portDistribution(0, portCount - 1);
+
+			attempt.firstPortIndex = portDistribution(randomDevice);
+		}
+
+		return ConnectToNextPort(std::move(attempt), connection, peerId, peerReactor);
+	}
+
+	bool ClientApplication::ConnectToNextPort(ConnectionAttempt attempt, ServerConnection* connection, std::size_t* peerId, NetworkReactor** peerReactor)
+	{
+		Nz::UInt16 firstPort = m_config.GetIntegerOption<Nz::UInt16>("Server.Port");
+		Nz::UInt16 portCount = m_config.GetIntegerOption<Nz::UInt16>("Server.PortCount");
+
+		Nz::UInt16 port = firstPort + (attempt.firstPortIndex + attempt.triedPortCount) % portCount;
+		attempt.triedPortCount++;
 
 		Nz::NetProtocol hostnameProtocol = (m_config.GetBoolOption("Options.ForceIPv4")) ? Nz::NetProtocol_IPv4 : Nz::NetProtocol_Any;
 
 		Nz::ResolveError resolveError = Nz::ResolveError_NoError;
-		std::vector<Nz::HostnameInfo> results = Nz::IpAddress::ResolveHostname(hostnameProtocol, serverHostname, Nz::String::Number(port), &resolveError);
+		std::vector<Nz::HostnameInfo> results = Nz::IpAddress::ResolveHostname(hostnameProtocol, attempt.hostname, Nz::String::Number(port), &resolveError);
 		if (results.empty())
 		{
 			std::cerr << "Failed to resolve server hostname: " << Nz::ErrorToString(resolveError) << std::endl;
@@ -42,7 +68,7 @@ namespace ewn
 
 		auto ConnectWithReactor = [&](NetworkReactor* reactor) -> bool
 		{
-			std::size_t newPeerId = reactor->ConnectTo(serverAddress, data);
+			std::size_t newPeerId = reactor->ConnectTo(serverAddress, attempt.data);
 			if (newPeerId == NetworkReactor::InvalidPeerId)
 			{
 				std::cerr << "Failed to allocate new peer" << std::endl;
@@ -53,8 +79,12 @@ namespace ewn
 			*peerReactor = reactor;
 
 			if (newPeerId >= m_servers.size())
+			{
+				m_connectionAttempts.resize(newPeerId + 1);
 				m_servers.resize(newPeerId + 1);
+			}
 
+			m_connectionAttempts[newPeerId] = std::move(attempt);
 			m_servers[newPeerId] = connection;
 			return true;
 		};
@@ -71,19 +101,34 @@ namespace ewn
 		}
 
 		// We don't have any reactor compatible with the server's protocol, allocate a new one
-		std::size_t reactorId = AddReactor(std::make_unique<NetworkReactor>(reactorCount * MaxPeerCount, serverAddress.GetProtocol(), 0, MaxPeerCount));
+		std::size_t reactorId = AddReactor(std::make_unique<NetworkReactor>(reactorCount * m_maxServerCount, serverAddress.GetProtocol(), 0, m_maxServerCount));
 		return ConnectWithReactor(GetReactor(reactorId).get());
 	}
 
 	void ClientApplication::HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data)
 	{
+		m_connectionAttempts[peerId].reset();
 		m_servers[peerId]->NotifyConnected(data);
 	}
 
 	void ClientApplication::HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data)
 	{
-		m_servers[peerId]->NotifyDisconnected(data);
+		ServerConnection* server = m_servers[peerId];
 		m_servers[peerId] = nullptr;
+
+		// A server reactor refuses (ignores) connections once full, try the other ports before giving up
+		if (std::optional<ConnectionAttempt> attempt = std::move(m_connectionAttempts[peerId]))
+		{
+			m_connectionAttempts[peerId].reset();
+
+			if (attempt->triedPortCount < m_config.GetIntegerOption<Nz::UInt16>("Server.PortCount"))
+			{
+				if (ConnectToNextPort(std::move(*attempt), server, &server->m_peerId, &server->m_networkReactor))
+					return;
+			}
+		}
+
+		server->NotifyDisconnected(data);
 	}
 
 	void ClientApplication::HandlePeerInfo(std::size_t peerId, const NetworkReactor::PeerInfo& peerInfo)
@@ -119,5 +164,6 @@ namespace ewn
 
 		m_config.RegisterStringOption("Server.Address");
 		m_config.RegisterIntegerOption("Server.Port", 1, 0xFFFF);
+		m_config.RegisterIntegerOption("Server.PortCount", 1, 64);
 	}
 }
@@ -14,6 +14,7 @@
 #include <Client/ClientCommandStore.hpp>
 #include <Client/ServerConnection.hpp>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace ewn
@@ -23,14 +24,17 @@ namespace ewn
 		friend class ServerConnection;
 
 		public:
-			ClientApplication();
+			ClientApplication(std::size_t maxServerCount = 1);
 
 			virtual ~ClientApplication();
 
 			bool Run() override;
 
 		private:
+			struct ConnectionAttempt;
+
 			bool ConnectNewServer(const Nz::String& serverHostname, Nz::UInt32 data, ServerConnection* connection, std::size_t* peerId, NetworkReactor** peerReactor);
+			bool ConnectToNextPort(ConnectionAttempt attempt, ServerConnection* connection, std::size_t* peerId, NetworkReactor** peerReactor);
 
 			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data) override;
 			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data) override;
@@ -39,7 +43,17 @@ namespace ewn
 
 			void RegisterConfig();
 
+			struct ConnectionAttempt
+			{
+				Nz::String hostname;
+				Nz::UInt16 firstPortIndex;
+				Nz::UInt16 triedPortCount;
+				Nz::UInt32 data;
+			};
+
+			std::vector<std::optional<ConnectionAttempt>> m_connectionAttempts; //< Indexed by peer id, until the connection succeeds
 			std::vector<ServerConnection*> m_servers;
+			std::size_t m_maxServerCount;
 	};
 }
 
@@ -40,6 +40,8 @@ namespace ewn
 			inline const ClientApplication& GetApp() const;
 			inline const ConnectionInfo& GetConnectionInfo() const;
 			inline const NetworkStringStore& GetNetworkStringStore() const;
+			inline Nz::UInt64 GetReceivedBytes() const;
+			inline Nz::UInt64 GetSentBytes() const;
 
 			inline bool IsConnected() const;
 
@@ -107,6 +109,8 @@ namespace ewn
 			NetworkReactor* m_networkReactor;
 			ConnectionInfo m_connectionInfo;
 			Nz::UInt64 m_deltaTime;
+			Nz::UInt64 m_receivedBytes;
+			Nz::UInt64 m_sentBytes;
 			std::size_t m_peerId;
 			bool m_connected;
 	};
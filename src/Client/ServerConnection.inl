@@ -13,6 +13,8 @@ namespace ewn
 	m_application(application),
 	m_commandStore(this),
 	m_networkReactor(nullptr),
+	m_receivedBytes(0),
+	m_sentBytes(0),
 	m_peerId(NetworkReactor::InvalidPeerId),
 	m_connected(false)
 	{
@@ -44,6 +46,16 @@ namespace ewn
 		return m_stringStore;
 	}
 
+	inline Nz::UInt64 ServerConnection::GetReceivedBytes() const
+	{
+		return m_receivedBytes;
+	}
+
+	inline Nz::UInt64 ServerConnection::GetSentBytes() const
+	{
+		return m_sentBytes;
+	}
+
 	inline bool ServerConnection::IsConnected() const
 	{
 		return m_connected;
@@ -73,11 +85,15 @@ namespace ewn
 		Nz::NetPacket data;
 		m_commandStore.SerializePacket(data, packet);
 
+		m_sentBytes += data.GetDataSize();
+
 		m_networkReactor->SendData(m_peerId, command.channelId, command.flags, std::move(data));
 	}
 
 	inline void ServerConnection::DispatchIncomingPacket(Nz::NetPacket&& packet)
 	{
+		m_receivedBytes += packet.GetDataSize();
+
 		m_commandStore.UnserializePacket(m_peerId, std::move(packet));
 	}
 
@@ -21,22 +21,79 @@
 #include <NDK/Components.hpp>
 #include <Client/ClientApplication.hpp>
 #include <Client/Components/SoundEmitterComponent.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <iostream>
+#include <iterator>
 
 namespace ewn
 {
 	static constexpr bool showServerGhosts = false;
 
+	namespace
+	{
+		Nz::Vector3f HermiteInterpolation(const Nz::Vector3f& fromPosition, const Nz::Vector3f& fromVelocity, const Nz::Vector3f& toPosition, const Nz::Vector3f& toVelocity, float interval, float ratio)
+		{
+			float ratio2 = ratio * ratio;
+			float ratio3 = ratio2 * ratio;
+
+			float fromPositionFactor = 2.f * ratio3 - 3.f * ratio2 + 1.f;
+			float fromVelocityFactor = ratio3 - 2.f * ratio2 + ratio;
+			float toPositionFactor = -2.f * ratio3 + 3.f * ratio2;
+			float toVelocityFactor = ratio3 - ratio2;
+
+			// Velocities are per second, tangents are per interval
+			return fromPosition * fromPositionFactor + fromVelocity * (fromVelocityFactor * interval) + toPosition * toPositionFactor + toVelocity * (toVelocityFactor * interval);
+		}
+
+		// Snapshot entities are sorted by id
+		template<typename T>
+		const T* FindEntity(const std::vector<T>& entities, Nz::UInt32 id)
+		{
+			auto it = std::lower_bound(entities.begin(), entities.end(), id, [](const T& entity, Nz::UInt32 entityId)
+			{
+				return entity.id < entityId;
+			});
+
+			return (it != entities.end() && it->id == id) ? &*it : nullptr;
+		}
+
+		Nz::Quaternionf IntegrateRotation(const Nz::Quaternionf& rotation, const Nz::Vector3f& angularVelocity, float elapsedTime)
+		{
+			// Angular velocity is in world space (radians per second)
+			float angle = angularVelocity.GetLength() * elapsedTime;
+			if (Nz::NumberEquals(angle, 0.f))
+				return rotation;
+
+			Nz::Vector3f axis = Nz::Vector3f::Normalize(angularVelocity);
+			float halfSin = std::sin(angle / 2.f);
+
+			Nz::Quaternionf deltaRotation(std::cos(angle / 2.f), axis.x * halfSin, axis.y * halfSin, axis.z * halfSin);
+			return (deltaRotation * rotation).GetNormal();
+		}
+	}
+
 	ServerMatchEntities::ServerMatchEntities(ClientApplication* app, ServerConnection* server, Ndk::WorldHandle world) :
 	m_jitterBuffer(m_jitterBufferData.begin(), m_jitterBufferData.end()),
 	m_world(std::move(world)),
+	m_lastSnapshotTime(0),
+	m_predictedEntityId(0),
+	m_freeSnapshotCount(JitterBufferSize),
 	m_app(app),
 	m_server(server),
+	m_hasJitterEstimation(false),
 	m_stateHandlingEnabled(true),
 	m_correctionAccumulator(0.f),
-	m_snapshotUpdateAccumulator(0.f)
+	m_playoutDelay(0.f),
+	m_snapshotInterval(1000.f / 30.f),
+	m_snapshotUpdateAccumulator(0.f),
+	m_targetPlayoutDelay(0.f),
+	m_transitMean(0.f),
+	m_transitVariance(0.f)
 	{
-		m_snapshotDelay = m_jitterBuffer.size() * 1000 / 30 /* + ping? */;
+		for (std::size_t i = 0; i < JitterBufferSize; ++i)
+			m_freeSnapshots[i] = &m_snapshotPool[i];
 
 		m_onArenaParticleSystemsSlot.Connect(server->OnArenaParticleSystems, this, &ServerMatchEntities::OnArenaParticleSystems);
 		m_onArenaPrefabsSlot.Connect(server->OnArenaPrefabs, this, &ServerMatchEntities::OnArenaPrefabs);
@@ -83,12 +140,23 @@ namespace ewn
 
 		if (m_stateHandlingEnabled)
 		{
+			UpdatePlayoutDelay(elapsedTime);
+
 			Nz::UInt64 serverTime = m_server->EstimateServerTime();
-			if (!m_jitterBuffer.empty() && serverTime >= m_jitterBuffer.front().applyTime)
+			Nz::UInt64 playoutDelay = static_cast<Nz::UInt64>(m_playoutDelay);
+			Nz::UInt64 playoutTime = (serverTime > playoutDelay) ? serverTime - playoutDelay : 0;
+
+			// Keep the last snapshot before playout time at the front of the buffer, we're interpolating from it
+			while (m_jitterBuffer.size() >= 2 && playoutTime >= (*std::next(m_jitterBuffer.begin()))->serverTime)
 			{
-				ApplySnapshot(m_jitterBuffer.front());
-				m_jitterBuffer.pop_back();
+				RecordSamples(*m_jitterBuffer.front());
+
+				m_freeSnapshots[m_freeSnapshotCount++] = m_jitterBuffer.front();
+				m_jitterBuffer.pop_front();
 			}
+
+			if (!m_jitterBuffer.empty() && playoutTime >= m_jitterBuffer.front()->serverTime)
+				InterpolateSnapshots(playoutTime);
 		}
 
 		constexpr float errorCorrectionInterval = 1.f / 60.f;
@@ -103,15 +171,6 @@ namespace ewn
 				if (!spaceshipData.entity)
 					continue;
 
-				auto& entityNode = spaceshipData.entity->GetComponent<Ndk::NodeComponent>();
-				auto& entityPhys = spaceshipData.entity->GetComponent<Ndk::PhysicsComponent3D>();
-
-				//if (spaceshipData.entity->GetId() == 9)
-				//	std::cout << "#" << spaceshipData.entity->GetId() << ": " << entityPhys.GetLinearVelocity() << " " << entityPhys.GetAngularVelocity() << std::endl;
-
-				entityNode.SetPosition(entityPhys.GetPosition() + spaceshipData.positionError);
-				entityNode.SetRotation(entityPhys.GetRotation() * spaceshipData.rotationError);
-
 				//spaceshipData.positionError += entityPhys.GetLinearVelocity();
 
 				/*if (spaceshipData.entity->GetId() == 9)
@@ -138,6 +197,19 @@ namespace ewn
 			}
 		}
 
+		// Interpolation runs every frame, so should the visual update
+		for (auto& spaceshipData : m_serverEntities)
+		{
+			if (!spaceshipData.entity)
+				continue;
+
+			auto& entityNode = spaceshipData.entity->GetComponent<Ndk::NodeComponent>();
+			auto& entityPhys = spaceshipData.entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+			entityNode.SetPosition(entityPhys.GetPosition() + spaceshipData.positionError);
+			entityNode.SetRotation(entityPhys.GetRotation() * spaceshipData.rotationError);
+		}
+
 		/*if constexpr (showServerGhosts)
 		{
 			Nz::NetPacket packet;
@@ -703,10 +775,48 @@ namespace ewn
 		}
 	}
 
-	void ServerMatchEntities::OnArenaState(ServerConnection* server, const Packets::ArenaState& arenaState)
+	void ServerMatchEntities::OnArenaState(ServerConnection* server, const Packets::ArenaState& packet)
 	{
-		// For now, allocate a new snapshot, we will recycle them in a further iteration (to prevent memory allocation)
-		Snapshot snapshot;
+		// Rebuild the full state from its baseline, if we lost the baseline the server will fall back to a full state after a while
+		Packets::ArenaState& arenaState = m_arenaState;
+		arenaState.stateId = packet.stateId;
+		arenaState.baselineId = packet.baselineId;
+		arenaState.serverTime = packet.serverTime;
+		arenaState.entities.assign(packet.entities.begin(), packet.entities.end());
+		arenaState.removedEntities.assign(packet.removedEntities.begin(), packet.removedEntities.end());
+		arenaState.lastProcessedInputTime = packet.lastProcessedInputTime;
+
+		if (!m_stateHistory.ResolveDelta(arenaState))
+			return;
+
+		m_stateHistory.RegisterState(arenaState);
+
+		Packets::ArenaStateAck ack;
+		ack.stateId = arenaState.stateId;
+
+		server->SendPacket(ack);
+
+		UpdateJitterEstimation(arenaState.serverTime);
+
+		// Snapshots have to stay ordered for interpolation, a late one is of no use anyway
+		if (!m_jitterBuffer.empty() && arenaState.serverTime <= m_jitterBuffer.back()->serverTime)
+			return;
+
+		// Our own spaceship doesn't go through the jitter buffer, prediction wants the latest state right away
+		if (m_predictedEntityId != 0 && IsServerEntityValid(m_predictedEntityId))
+		{
+			for (const Packets::ArenaState::Entity& entity : arenaState.entities)
+			{
+				if (entity.id == m_predictedEntityId)
+				{
+					OnPredictedEntityState(this, GetServerEntity(entity.id), entity, arenaState.serverTime, arenaState.lastProcessedInputTime);
+					break;
+				}
+			}
+		}
+
+		// Entity arrays keep their capacity between uses, reception doesn't allocate once the pool has warmed up
+		Snapshot& snapshot = PushSnapshot();
 		snapshot.entities.resize(arenaState.entities.size());
 		for (std::size_t i = 0; i < snapshot.entities.size(); ++i)
 		{
@@ -720,16 +830,21 @@ namespace ewn
 			entity.rotation = packetEntity.rotation;
 		}
 
-		snapshot.applyTime = arenaState.serverTime + m_snapshotDelay;
-		snapshot.stateId = arenaState.stateId;
+		// Interpolation walks two consecutive snapshots side by side
+		std::sort(snapshot.entities.begin(), snapshot.entities.end(), [](const Snapshot::Entity& lhs, const Snapshot::Entity& rhs)
+		{
+			return lhs.id < rhs.id;
+		});
 
-		m_jitterBuffer.push_back(std::move(snapshot));
+		snapshot.serverTime = arenaState.serverTime;
+		snapshot.stateId = arenaState.stateId;
 	}
 
 	void ServerMatchEntities::OnCreateEntity(ServerConnection*, const Packets::CreateEntity& createPacket)
 	{
 		ServerEntity& data = CreateServerEntity(createPacket.entityId);
 
+		data.isExtrapolating = false;
 		data.positionError = Nz::Vector3f::Zero();
 		data.rotationError = Nz::Quaternionf::Identity();
 
@@ -807,43 +922,180 @@ namespace ewn
 		sound.Play();
 	}
 
-	void ServerMatchEntities::ApplySnapshot(const Snapshot& snapshot)
+	ServerMatchEntities::Snapshot& ServerMatchEntities::PushSnapshot()
+	{
+		Snapshot* snapshot;
+		if (m_jitterBuffer.full())
+		{
+			// Drop the oldest snapshot and reuse it
+			snapshot = m_jitterBuffer.front();
+			RecordSamples(*snapshot);
+
+			m_jitterBuffer.pop_front();
+		}
+		else
+		{
+			assert(m_freeSnapshotCount > 0);
+			snapshot = m_freeSnapshots[--m_freeSnapshotCount];
+		}
+
+		m_jitterBuffer.push_back(snapshot);
+		return *snapshot;
+	}
+
+	void ServerMatchEntities::InterpolateSnapshots(Nz::UInt64 playoutTime)
 	{
-		//std::cout << "Applied snapshot #" << snapshot.stateId << " after " << (m_server->EstimateServerTime() - snapshot.applyTime) << "ms" << std::endl;
-		for (const Snapshot::Entity& entityData : snapshot.entities)
+		// Past that point we'd rather stop entities than show them going through walls
+		constexpr Nz::UInt64 maxExtrapolationTime = 250;
+
+		const Snapshot& fromSnapshot = *m_jitterBuffer.front();
+
+		for (ServerEntity& data : m_serverEntities)
 		{
-			if (!IsServerEntityValid(entityData.id))
+			if (!data.isValid || data.serverId == m_predictedEntityId)
 				continue;
 
-			ServerEntity& data = GetServerEntity(entityData.id);
+			// Entities aren't part of every snapshot, start from the last state we got if the current one doesn't include it
+			const Snapshot::Entity* fromEntity = FindEntity(fromSnapshot.entities, data.serverId);
+			Nz::UInt64 fromTime = fromSnapshot.serverTime;
+			if (!fromEntity)
+			{
+				const EntitySample& sample = m_entitySamples[data.serverId];
+				if (!sample.isValid)
+					continue;
+
+				fromEntity = &sample.state;
+				fromTime = sample.serverTime;
+			}
+
+			// Interpolate across the gap up to the next snapshot including it
+			const Snapshot::Entity* toEntity = nullptr;
+			Nz::UInt64 toTime = 0;
+			for (auto it = std::next(m_jitterBuffer.begin()); it != m_jitterBuffer.end(); ++it)
+			{
+				toEntity = FindEntity((*it)->entities, data.serverId);
+				if (toEntity)
+				{
+					toTime = (*it)->serverTime;
+					break;
+				}
+			}
+
+			Nz::Vector3f angularVelocity;
+			Nz::Vector3f linearVelocity;
+			Nz::Vector3f position;
+			Nz::Quaternionf rotation;
+
+			if (toEntity)
+			{
+				float interval = (toTime - fromTime) / 1000.f;
+				float ratio = float(playoutTime - fromTime) / float(toTime - fromTime);
+
+				position = HermiteInterpolation(fromEntity->position, fromEntity->linearVelocity, toEntity->position, toEntity->linearVelocity, interval, ratio);
+
+				// Rotate both ends toward each other using their own angular velocity, then blend them
+				Nz::Quaternionf fromRotation = IntegrateRotation(fromEntity->rotation, fromEntity->angularVelocity, ratio * interval);
+				Nz::Quaternionf toRotation = IntegrateRotation(toEntity->rotation, toEntity->angularVelocity, (ratio - 1.f) * interval);
+				rotation = Nz::Quaternionf::Slerp(fromRotation, toRotation, ratio);
+
+				angularVelocity = Nz::Lerp(fromEntity->angularVelocity, toEntity->angularVelocity, ratio);
+				linearVelocity = Nz::Lerp(fromEntity->linearVelocity, toEntity->linearVelocity, ratio);
+			}
+			else
+			{
+				// No buffered snapshot includes it yet, keep it moving for a while
+				Nz::UInt64 extrapolationTime = playoutTime - fromTime;
+				bool isExtrapolationBounded = (extrapolationTime > maxExtrapolationTime);
+				float extrapolationDuration = std::min(extrapolationTime, maxExtrapolationTime) / 1000.f;
+
+				position = fromEntity->position + fromEntity->linearVelocity * extrapolationDuration;
+				rotation = IntegrateRotation(fromEntity->rotation, fromEntity->angularVelocity, extrapolationDuration);
+
+				angularVelocity = (isExtrapolationBounded) ? Nz::Vector3f::Zero() : fromEntity->angularVelocity;
+				linearVelocity = (isExtrapolationBounded) ? Nz::Vector3f::Zero() : fromEntity->linearVelocity;
+			}
 
-			auto& entityNode = data.entity->GetComponent<Ndk::NodeComponent>();
 			auto& entityPhys = data.entity->GetComponent<Ndk::PhysicsComponent3D>();
 
-			// Compute visual error
-			Nz::Quaternionf visualRotation = entityNode.GetRotation();
-			Nz::Vector3f visualPosition = entityNode.GetPosition();
+			// Extrapolation was a guess, hide the correction in the visual error instead of snapping back
+			bool isExtrapolating = (toEntity == nullptr);
+			if (data.isExtrapolating && !isExtrapolating)
+			{
+				data.positionError += entityPhys.GetPosition() - position;
+				data.rotationError = data.rotationError * rotation.GetConjugate() * entityPhys.GetRotation();
+			}
+			data.isExtrapolating = isExtrapolating;
 
-			/*data.positionError = Nz::Vector3f::Zero();
-			data.rotationError = Nz::Quaternionf::Identity();*/
+			entityPhys.SetAngularVelocity(angularVelocity);
+			entityPhys.SetLinearVelocity(linearVelocity);
+			entityPhys.SetPosition(position);
+			entityPhys.SetRotation(rotation);
+		}
+	}
 
-			data.positionError += entityPhys.GetPosition() - entityData.position;
-			data.rotationError = data.rotationError * entityData.rotation.GetConjugate() * entityPhys.GetRotation();
+	void ServerMatchEntities::RecordSamples(const Snapshot& snapshot)
+	{
+		for (const Snapshot::Entity& entity : snapshot.entities)
+		{
+			if (entity.id >= m_entitySamples.size())
+				continue;
 
-			/*if (float diff = Nz::Vector3f::Distance(entityPhys.GetPosition() + data.positionError, visualPosition); diff > 0.0001f)
-				std::cout << "Distance: " << Nz::Vector3f::Distance(entityPhys.GetPosition() + data.positionError, visualPosition) << std::endl;
+			EntitySample& sample = m_entitySamples[entity.id];
+			sample.state = entity;
+			sample.serverTime = snapshot.serverTime;
+			sample.isValid = true;
+		}
+	}
 
-			Nz::Quaternionf test = visualRotation * (entityPhys.GetRotation() * data.rotationError).GetInverse();
-			Nz::Vector3f testVec(test.x, test.y, test.z);
+	void ServerMatchEntities::UpdateJitterEstimation(Nz::UInt64 snapshotTime)
+	{
+		constexpr float estimationFactor = 1.f / 16.f;
 
-			if (float diff = std::atan2(testVec.GetLength(), test.w); diff > 0.0001f)
-				std::cout << "Rotation: " << diff << std::endl;*/
+		// Transit time includes the clock estimation error, which is fine as long as it's stable: only its variation matters
+		float transitTime = static_cast<float>(static_cast<Nz::Int64>(m_server->EstimateServerTime() - snapshotTime));
 
-			// Hard apply physics state
-			entityPhys.SetAngularVelocity(entityData.angularVelocity);
-			entityPhys.SetLinearVelocity(entityData.linearVelocity);
-			entityPhys.SetPosition(entityData.position);
-			entityPhys.SetRotation(entityData.rotation);
+		bool firstEstimation = !m_hasJitterEstimation;
+		if (firstEstimation)
+		{
+			// Start conservative, a clean link will bring the delay down after a few snapshots
+			m_transitMean = transitTime;
+			m_transitVariance = m_snapshotInterval * m_snapshotInterval;
+			m_hasJitterEstimation = true;
 		}
+		else
+		{
+			float deviation = transitTime - m_transitMean;
+			m_transitMean += estimationFactor * deviation;
+			m_transitVariance += estimationFactor * (deviation * deviation - m_transitVariance);
+
+			// Late or duplicated states don't tell us anything about the sending rate
+			if (snapshotTime > m_lastSnapshotTime)
+				m_snapshotInterval += estimationFactor * (static_cast<float>(snapshotTime - m_lastSnapshotTime) - m_snapshotInterval);
+		}
+
+		m_lastSnapshotTime = std::max(m_lastSnapshotTime, snapshotTime);
+
+		// Cover most of the transit time distribution, plus one interval as interpolation needs the next snapshot as well
+		// without asking for more snapshots than the buffer can hold
+		constexpr float jitterDeviationFactor = 3.f;
+
+		float maxDelay = m_snapshotInterval * (JitterBufferSize - 1);
+		m_targetPlayoutDelay = Nz::Clamp(m_snapshotInterval + m_transitMean + jitterDeviationFactor * std::sqrt(m_transitVariance), 0.f, maxDelay);
+
+		// Nothing is being played yet, no need to ease into it
+		if (firstEstimation)
+			m_playoutDelay = m_targetPlayoutDelay;
+	}
+
+	void ServerMatchEntities::UpdatePlayoutDelay(float elapsedTime)
+	{
+		if (!m_hasJitterEstimation)
+			return;
+
+		// Speed up or slow down playout by a few percents instead of jumping, so it doesn't show
+		constexpr float maxTimeScaleAdjustment = 0.05f;
+
+		float maxDelayChange = maxTimeScaleAdjustment * elapsedTime * 1000.f;
+		m_playoutDelay += Nz::Clamp(m_targetPlayoutDelay - m_playoutDelay, -maxDelayChange, maxDelayChange);
 	}
 }
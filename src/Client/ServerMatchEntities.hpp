@@ -14,6 +14,7 @@
 #include <Nazara/Network/UdpSocket.hpp>
 #include <NDK/EntityOwner.hpp>
 #include <NDK/World.hpp>
+#include <Shared/Protocol/ArenaStateHistory.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/ServerConnection.hpp>
 #include <nonstd/ring_span.hpp>
@@ -41,6 +42,8 @@ namespace ewn
 			inline bool IsSnapshotHandlingEnabled() const;
 			inline bool IsServerEntityValid(std::size_t id) const;
 
+			inline void SetPredictedEntity(Nz::UInt32 id);
+
 			void Update(float elapsedTime);
 
 			ServerMatchEntities& operator=(const ServerMatchEntities&) = delete;
@@ -54,12 +57,14 @@ namespace ewn
 				Nz::Quaternionf rotationError;
 				Nz::Vector3f positionError;
 				Nz::UInt32 serverId;
+				bool isExtrapolating = false;
 				bool isValid = false;
 				std::string name; //< remove asap, used for temporary client-side radar
 			};
 
 			NazaraSignal(OnEntityCreated, ServerMatchEntities* /*emitter*/, ServerEntity& /*entity*/);
 			NazaraSignal(OnEntityDelete,  ServerMatchEntities* /*emitter*/, ServerEntity& /*entity*/);
+			NazaraSignal(OnPredictedEntityState, ServerMatchEntities* /*emitter*/, ServerEntity& /*entity*/, const Packets::ArenaState::Entity& /*state*/, Nz::UInt64 /*serverTime*/, Nz::UInt64 /*lastProcessedInputTime*/);
 
 		private:
 			struct Snapshot;
@@ -77,7 +82,11 @@ namespace ewn
 			void OnInstantiateParticleSystem(ServerConnection* server, const Packets::InstantiateParticleSystem& instantiatePacket);
 			void OnPlaySound(ServerConnection* server, const Packets::PlaySound& playSound);
 
-			void ApplySnapshot(const Snapshot& snapshot);
+			void InterpolateSnapshots(Nz::UInt64 playoutTime);
+			Snapshot& PushSnapshot();
+			void RecordSamples(const Snapshot& snapshot);
+			void UpdateJitterEstimation(Nz::UInt64 snapshotTime);
+			void UpdatePlayoutDelay(float elapsedTime);
 
 			struct ParticleSystem
 			{
@@ -102,11 +111,19 @@ namespace ewn
 					Nz::Quaternionf rotation;
 				};
 
-				Nz::UInt64 applyTime;
+				Nz::UInt64 serverTime;
 				Nz::UInt16 stateId;
 				std::vector<Entity> entities;
 			};
 
+			// Last state received for an entity, used when the snapshot we're interpolating from doesn't include it
+			struct EntitySample
+			{
+				Snapshot::Entity state;
+				Nz::UInt64 serverTime;
+				bool isValid = false;
+			};
+
 			NazaraSlot(ServerConnection, OnArenaParticleSystems,      m_onArenaParticleSystemsSlot);
 			NazaraSlot(ServerConnection, OnArenaPrefabs,              m_onArenaPrefabsSlot);
 			NazaraSlot(ServerConnection, OnArenaSounds,               m_onArenaSoundsSlot);
@@ -118,10 +135,18 @@ namespace ewn
 
 			using PrefabFactoryFunction = std::function<void(ClientApplication* app, const Ndk::EntityHandle& entity)>;
 
-			std::array<Snapshot, 5> m_jitterBufferData;
-			nonstd::ring_span<Snapshot> m_jitterBuffer;
+			static constexpr std::size_t JitterBufferSize = 16;
+
+			// Snapshots never leave the pool, the jitter buffer and the free list only hold pointers to them
+			std::array<Snapshot, JitterBufferSize> m_snapshotPool;
+			std::array<Snapshot*, JitterBufferSize> m_freeSnapshots;
+			std::array<Snapshot*, JitterBufferSize> m_jitterBufferData;
+			ArenaStateHistory m_stateHistory;
+			Packets::ArenaState m_arenaState;
+			nonstd::ring_span<Snapshot*, nonstd::null_popper<Snapshot*>> m_jitterBuffer;
 			std::mt19937 m_randomGenerator;
 			std::unordered_map<std::string, PrefabFactoryFunction> m_visualEffectFactory;
+			std::vector<EntitySample> m_entitySamples;
 			std::vector<Ndk::EntityOwner> m_prefabs;
 			std::vector<Nz::Sound> m_playingSounds;
 			std::vector<ParticleSystem> m_particleSystems;
@@ -129,12 +154,20 @@ namespace ewn
 			std::vector<ServerEntity> m_serverEntities;
 			Ndk::WorldHandle m_world;
 			Nz::UdpSocket m_debugStateSocket;
-			Nz::UInt64 m_snapshotDelay;
+			Nz::UInt64 m_lastSnapshotTime;
+			Nz::UInt32 m_predictedEntityId;
+			std::size_t m_freeSnapshotCount;
 			ClientApplication* m_app;
 			ServerConnection* m_server;
+			bool m_hasJitterEstimation;
 			bool m_stateHandlingEnabled;
 			float m_correctionAccumulator;
+			float m_playoutDelay;
+			float m_snapshotInterval;
 			float m_snapshotUpdateAccumulator;
+			float m_targetPlayoutDelay;
+			float m_transitMean;
+			float m_transitVariance;
 	};
 }
 
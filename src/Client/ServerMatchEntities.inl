@@ -14,7 +14,13 @@ namespace ewn
 	inline ServerMatchEntities::ServerEntity& ServerMatchEntities::CreateServerEntity(Nz::UInt32 id)
 	{
 		if (id >= m_serverEntities.size())
+		{
+			m_entitySamples.resize(id + 1);
 			m_serverEntities.resize(id + 1);
+		}
+
+		// Don't interpolate from a sample of the previous entity using this id
+		m_entitySamples[id].isValid = false;
 
 		ServerEntity& data = m_serverEntities[id];
 		assert(!data.isValid);
@@ -45,4 +51,10 @@ namespace ewn
 	{
 		return id < m_serverEntities.size() && m_serverEntities[id].isValid;
 	}
+
+	// The predicted entity isn't interpolated, its states go through OnPredictedEntityState as soon as they arrive (0 for none)
+	inline void ServerMatchEntities::SetPredictedEntity(Nz::UInt32 id)
+	{
+		m_predictedEntityId = id;
+	}
 }
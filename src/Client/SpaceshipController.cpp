@@ -16,7 +16,7 @@
 
 namespace ewn
 {
-	SpaceshipController::SpaceshipController(ClientApplication* app, ServerConnection* server, Nz::RenderWindow& window, Ndk::World& world2D, MatchChatbox& chatbox, ServerMatchEntities& entities, const Ndk::EntityHandle& camera, const Ndk::EntityHandle& spaceship) :
+	SpaceshipController::SpaceshipController(ClientApplication* app, ServerConnection* server, Nz::RenderWindow& window, Ndk::World& world2D, MatchChatbox& chatbox, ServerMatchEntities& entities, const Ndk::EntityHandle& camera, const Ndk::EntityHandle& spaceship, const Nz::Vector3f& spaceshipInertia) :
 	m_app(app),
 	m_chatbox(chatbox),
 	m_entities(entities),
@@ -25,7 +25,11 @@ namespace ewn
 	m_window(window),
 	m_camera(camera),
 	m_spaceship(spaceship),
+	m_lastInputTime(0),
 	m_lastShootTime(0),
+	m_inputHistory(m_inputHistoryData.begin(), m_inputHistoryData.end()),
+	m_unsentInputCount(0),
+	m_spaceshipInertia(spaceshipInertia),
 	m_executeScript(false),
 	m_inputAccumulator(0.f)
 	{
@@ -47,6 +51,14 @@ namespace ewn
 		m_onMouseMovedSlot.Connect(eventHandler.OnMouseMoved, this, &SpaceshipController::OnMouseMoved);
 		m_onBotMessage.Connect(m_server->OnBotMessage, this, &SpaceshipController::OnBotMessage);
 		m_onTargetChangeSizeSlot.Connect(m_window.OnRenderTargetSizeChange, this, &SpaceshipController::OnRenderTargetSizeChange);
+		m_onPredictedEntityStateSlot.Connect(m_entities.OnPredictedEntityState, this, &SpaceshipController::OnPredictedEntityState);
+
+		// Start predicting from the last known state
+		auto& spaceshipPhys = m_spaceship->GetComponent<Ndk::PhysicsComponent3D>();
+		m_predictedState.angularVelocity = spaceshipPhys.GetAngularVelocity();
+		m_predictedState.linearVelocity = spaceshipPhys.GetLinearVelocity();
+		m_predictedState.position = spaceshipPhys.GetPosition();
+		m_predictedState.rotation = spaceshipPhys.GetRotation();
 
 		LoadSprites(world2D);
 		OnRenderTargetSizeChange(&m_window);
@@ -71,6 +83,9 @@ namespace ewn
 			UpdateInput(inputSendInterval);
 		}
 
+		SpaceshipMovement::Integrate(m_predictedState, elapsedTime);
+		UpdatePredictedSpaceship();
+
 		if (m_executeScript)
 		{
 			if (m_controlScript.GetGlobal("OnUpdate") == Nz::LuaType_Function)
@@ -255,6 +270,43 @@ namespace ewn
 		}
 	}
 
+	void SpaceshipController::OnPredictedEntityState(ServerMatchEntities* /*entities*/, ServerMatchEntities::ServerEntity& entityData, const Packets::ArenaState::Entity& state, Nz::UInt64 serverTime, Nz::UInt64 lastProcessedInputTime)
+	{
+		// Inputs the server already processed are part of the state it sent us
+		while (!m_inputHistory.empty() && m_inputHistory.front().inputTime <= lastProcessedInputTime)
+			m_inputHistory.pop_front();
+
+		SpaceshipMovement::State serverState;
+		serverState.angularVelocity = state.angularVelocity;
+		serverState.linearVelocity = state.linearVelocity;
+		serverState.position = state.position;
+		serverState.rotation = state.rotation;
+
+		// Replay the remaining ones on top of it, up to now
+		Nz::UInt64 stateTime = serverTime;
+		for (const PredictedInput& input : m_inputHistory)
+		{
+			if (input.inputTime > stateTime)
+			{
+				SpaceshipMovement::Integrate(serverState, (input.inputTime - stateTime) / 1000.f);
+				stateTime = input.inputTime;
+			}
+
+			SpaceshipMovement::ApplyInput(serverState, m_spaceshipInertia, input.elapsedTime, input.movement, input.rotation);
+		}
+
+		Nz::UInt64 currentTime = m_server->EstimateServerTime();
+		if (currentTime > stateTime)
+			SpaceshipMovement::Integrate(serverState, (currentTime - stateTime) / 1000.f);
+
+		// Hide the misprediction in the visual error instead of snapping
+		entityData.positionError += m_predictedState.position - serverState.position;
+		entityData.rotationError = entityData.rotationError * serverState.rotation.GetConjugate() * m_predictedState.rotation;
+
+		m_predictedState = serverState;
+		UpdatePredictedSpaceship();
+	}
+
 	void SpaceshipController::OnRenderTargetSizeChange(const Nz::RenderTarget* renderTarget)
 	{
 		if (m_executeScript)
@@ -732,6 +784,28 @@ namespace ewn
 		}
 	}
 
+	void SpaceshipController::SendInputs()
+	{
+		if (m_inputHistory.empty())
+			return;
+
+		// Repeat the last inputs the server didn't acknowledge yet, so a lost packet doesn't lose any
+		Nz::UInt64 lastInputTime = m_inputHistory.back().inputTime;
+
+		Packets::PlayerMovement movementPacket;
+		movementPacket.inputTime = lastInputTime;
+
+		for (auto it = m_inputHistory.rbegin(); it != m_inputHistory.rend() && movementPacket.inputs.size() < RedundantInputCount; ++it)
+		{
+			auto& input = movementPacket.inputs.emplace_back();
+			input.timeOffset = static_cast<Nz::UInt32>(lastInputTime - it->inputTime);
+			input.direction = it->movement;
+			input.rotation = it->rotation;
+		}
+
+		m_server->SendPacket(movementPacket);
+	}
+
 	void SpaceshipController::Shoot()
 	{
 		Nz::UInt64 currentTime = ClientApplication::GetAppTime();
@@ -746,6 +820,17 @@ namespace ewn
 
 	void SpaceshipController::UpdateInput(float elapsedTime)
 	{
+		// Inputs are sent by packs of InputsPerPacket, don't hold the last ones back if input generation stopped
+		bool hasNewInput = false;
+		Nz::CallOnExit flushInputs([&]()
+		{
+			if (!hasNewInput && m_unsentInputCount > 0)
+			{
+				SendInputs();
+				m_unsentInputCount = 0;
+			}
+		});
+
 		if (m_executeScript)
 		{
 			m_controlScript.GetGlobal("UpdateInput");
@@ -774,19 +859,48 @@ namespace ewn
 					return;
 				}
 
-				// Send input to server
-				Packets::PlayerMovement movementPacket;
-				movementPacket.inputTime = m_server->EstimateServerTime();
-				movementPacket.direction = movement;
-				movementPacket.rotation = rotation;
+				// Server ignores inputs going back in time (which may happen after a clock resynchronization)
+				Nz::UInt64 inputTime = m_server->EstimateServerTime();
+				if (inputTime > m_lastInputTime)
+				{
+					PredictedInput predictedInput;
+					predictedInput.elapsedTime = (m_lastInputTime != 0) ? (inputTime - m_lastInputTime) / 1000.f : 0.f;
+					predictedInput.inputTime = inputTime;
+
+					// Same clamping as the server
+					for (std::size_t i = 0; i < 3; ++i)
+					{
+						predictedInput.movement[i] = Nz::Clamp(movement[i], -1.f, 1.f);
+						predictedInput.rotation[i] = Nz::Clamp(rotation[i], -1.f, 1.f);
+					}
+
+					SpaceshipMovement::ApplyInput(m_predictedState, m_spaceshipInertia, predictedInput.elapsedTime, predictedInput.movement, predictedInput.rotation);
 
-				m_server->SendPacket(movementPacket);
+					m_inputHistory.push_back(predictedInput);
+					m_lastInputTime = inputTime;
+					hasNewInput = true;
+
+					if (++m_unsentInputCount >= InputsPerPacket)
+					{
+						SendInputs();
+						m_unsentInputCount = 0;
+					}
+				}
 			}
 			else
 				std::cerr << "UpdateInput failed: " << m_controlScript.GetLastError() << std::endl;
 		}
 	}
 
+	void SpaceshipController::UpdatePredictedSpaceship()
+	{
+		auto& spaceshipPhys = m_spaceship->GetComponent<Ndk::PhysicsComponent3D>();
+		spaceshipPhys.SetAngularVelocity(m_predictedState.angularVelocity);
+		spaceshipPhys.SetLinearVelocity(m_predictedState.linearVelocity);
+		spaceshipPhys.SetPosition(m_predictedState.position);
+		spaceshipPhys.SetRotation(m_predictedState.rotation);
+	}
+
 	void SpaceshipController::PushToLua(const Nz::WindowEvent::KeyEvent& event)
 	{
 		m_controlScript.PushTable(0, 6);
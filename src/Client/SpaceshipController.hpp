@@ -13,19 +13,22 @@
 #include <Nazara/Renderer/RenderWindow.hpp>
 #include <NDK/Entity.hpp>
 #include <NDK/EntityOwner.hpp>
+#include <Shared/SpaceshipMovement.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/ServerConnection.hpp>
+#include <Client/ServerMatchEntities.hpp>
+#include <nonstd/ring_span.hpp>
+#include <array>
 
 namespace ewn
 {
 	class ClientApplication;
 	class MatchChatbox;
-	class ServerMatchEntities;
 
 	class SpaceshipController
 	{
 		public:
-			SpaceshipController(ClientApplication* app, ServerConnection* server, Nz::RenderWindow& window, Ndk::World& world2D, MatchChatbox& chatbox, ServerMatchEntities& entities, const Ndk::EntityHandle& camera, const Ndk::EntityHandle& spaceship);
+			SpaceshipController(ClientApplication* app, ServerConnection* server, Nz::RenderWindow& window, Ndk::World& world2D, MatchChatbox& chatbox, ServerMatchEntities& entities, const Ndk::EntityHandle& camera, const Ndk::EntityHandle& spaceship, const Nz::Vector3f& spaceshipInertia);
 			SpaceshipController(const SpaceshipController&) = delete;
 			SpaceshipController(SpaceshipController&&) = delete;
 			~SpaceshipController();
@@ -36,6 +39,14 @@ namespace ewn
 			SpaceshipController& operator=(SpaceshipController&&) = delete;
 
 		private:
+			struct PredictedInput
+			{
+				Nz::UInt64 inputTime;
+				Nz::Vector3f movement;
+				Nz::Vector3f rotation;
+				float elapsedTime;
+			};
+
 			struct Sprite
 			{
 				Ndk::EntityOwner entity;
@@ -56,12 +67,15 @@ namespace ewn
 
 			void OnMouseButtonReleased(const Nz::EventHandler* eventHandler, const Nz::WindowEvent::MouseButtonEvent& event);
 			void OnMouseMoved(const Nz::EventHandler* eventHandler, const Nz::WindowEvent::MouseMoveEvent& event);
+			void OnPredictedEntityState(ServerMatchEntities* entities, ServerMatchEntities::ServerEntity& entityData, const Packets::ArenaState::Entity& state, Nz::UInt64 serverTime, Nz::UInt64 lastProcessedInputTime);
 			void OnRenderTargetSizeChange(const Nz::RenderTarget* renderTarget);
 
 			void LoadScript();
 			void LoadSprites(Ndk::World& world2D);
+			void SendInputs();
 			void Shoot();
 			void UpdateInput(float elapsedTime);
+			void UpdatePredictedSpaceship();
 
 			NazaraSlot(ServerConnection, OnIntegrityUpdate, m_onIntegrityUpdateSlot);
 			NazaraSlot(ServerConnection, OnBotMessage, m_onBotMessage);
@@ -72,7 +86,13 @@ namespace ewn
 			NazaraSlot(Nz::EventHandler, OnMouseButtonReleased, m_onMouseButtonReleasedSlot);
 			NazaraSlot(Nz::EventHandler, OnMouseMoved, m_onMouseMovedSlot);
 			NazaraSlot(Nz::RenderTarget, OnRenderTargetSizeChange, m_onTargetChangeSizeSlot);
+			NazaraSlot(ServerMatchEntities, OnPredictedEntityState, m_onPredictedEntityStateSlot);
+
+			static constexpr std::size_t InputHistorySize = 128;
+			static constexpr std::size_t InputsPerPacket = 2;
+			static constexpr std::size_t RedundantInputCount = Packets::PlayerMovement::MaxInputCount;
 
+			std::array<PredictedInput, InputHistorySize> m_inputHistoryData;
 			std::vector<Sprite> m_sprites;
 			ClientApplication* m_app;
 			MatchChatbox& m_chatbox;
@@ -88,8 +108,13 @@ namespace ewn
 			Nz::SpriteRef m_cursorOrientationSprite;
 			Nz::SpriteRef m_healthBarSprite;
 			Nz::Sound m_shootSound;
+			Nz::UInt64 m_lastInputTime;
 			Nz::UInt64 m_lastShootTime;
+			nonstd::ring_span<PredictedInput> m_inputHistory;
+			SpaceshipMovement::State m_predictedState;
+			std::size_t m_unsentInputCount;
 			Nz::Vector3f m_cameraRotation;
+			Nz::Vector3f m_spaceshipInertia;
 			bool m_executeScript;
 			float m_inputAccumulator;
 	};
@@ -48,6 +48,7 @@ namespace ewn
 			stateData.world3D->GetSystem<Ndk::RenderSystem>().SetDefaultBackground(Nz::ColorBackground::New(Nz::Color::Black));
 
 		m_controlledEntity = std::numeric_limits<decltype(m_controlledEntity)>::max();
+		m_controlledEntityInertia = Nz::Vector3f::Zero();
 
 		ConnectSignal(stateData.server->OnControlEntity, this, &ArenaState::OnControlEntity);
 		ConnectSignal(stateData.window->GetEventHandler().OnKeyPressed, this, &ArenaState::OnKeyPressed);
@@ -122,6 +123,7 @@ namespace ewn
 			}
 
 			m_spaceshipController.reset();
+			m_matchEntities->SetPredictedEntity(0);
 		}
 
 		if (entityId != std::numeric_limits<std::size_t>::max() && m_matchEntities->IsServerEntityValid(entityId))
@@ -132,7 +134,8 @@ namespace ewn
 			if (data.textEntity)
 				data.textEntity->Disable();
 
-			m_spaceshipController.emplace(stateData.app, stateData.server, *stateData.window, *stateData.world2D, *m_chatbox, *m_matchEntities, stateData.camera3D, data.entity);
+			m_spaceshipController.emplace(stateData.app, stateData.server, *stateData.window, *stateData.world2D, *m_chatbox, *m_matchEntities, stateData.camera3D, data.entity, m_controlledEntityInertia);
+			m_matchEntities->SetPredictedEntity(static_cast<Nz::UInt32>(entityId));
 		}
 
 		m_controlledEntity = entityId;
@@ -140,6 +143,8 @@ namespace ewn
 
 	void ArenaState::OnControlEntity(ServerConnection*, const Packets::ControlEntity& controlPacket)
 	{
+		m_controlledEntityInertia = controlPacket.inertia;
+
 		ControlEntity((controlPacket.id != 0) ? controlPacket.id : std::numeric_limits<std::size_t>::max());
 	}
 
@@ -45,6 +45,7 @@ namespace ewn
 			std::optional<ServerMatchEntities> m_matchEntities;
 			std::optional<SpaceshipController> m_spaceshipController;
 			std::size_t m_controlledEntity;
+			Nz::Vector3f m_controlledEntityInertia;
 			Nz::UInt8 m_arenaIndex;
 	};
 }
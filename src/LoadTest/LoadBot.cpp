@@ -0,0 +1,339 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon LoadTest" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/LoadBot.hpp>
+#include <Client/ClientApplication.hpp>
+#include <argon2/argon2.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace ewn
+{
+	LoadBot::LoadBot(ClientApplication& app, std::size_t botIndex, const Settings& settings) :
+	m_login(settings.loginPrefix + std::to_string(botIndex)),
+	m_settings(settings),
+	m_server(app),
+	m_sentInputs(m_sentInputData.begin(), m_sentInputData.end()),
+	m_status(Status::Idle),
+	m_nextTimeSyncRequestId(0),
+	m_hasHullList(false),
+	m_hasModuleList(false),
+	m_isClockSynchronized(false),
+	m_isConnected(false),
+	m_movementAccumulator(0.f),
+	m_movementTime(float(botIndex)), //< Don't have every bot follow the same path
+	m_timeSyncAccumulator(0.f)
+	{
+		m_server.OnArenaState.Connect([this](ServerConnection*, const Packets::ArenaState& data) { OnArenaState(data); });
+		m_server.OnConnected.Connect([this](ServerConnection*, Nz::UInt32) { OnConnected(); });
+		m_server.OnDisconnected.Connect([this](ServerConnection*, Nz::UInt32) { OnDisconnected(); });
+		m_server.OnHullList.Connect([this](ServerConnection*, const Packets::HullList& data) { OnHullList(data); });
+		m_server.OnLoginFailure.Connect([this](ServerConnection*, const Packets::LoginFailure& data) { OnLoginFailure(data); });
+		m_server.OnLoginSuccess.Connect([this](ServerConnection*, const Packets::LoginSuccess&) { OnLoginSuccess(); });
+		m_server.OnModuleList.Connect([this](ServerConnection*, const Packets::ModuleList& data) { OnModuleList(data); });
+		m_server.OnRegisterFailure.Connect([this](ServerConnection*, const Packets::RegisterFailure& data) { OnRegisterFailure(data); });
+		m_server.OnRegisterSuccess.Connect([this](ServerConnection*, const Packets::RegisterSuccess&) { SendLoginPacket(); });
+		m_server.OnTimeSyncResponse.Connect([this](ServerConnection*, const Packets::TimeSyncResponse& data) { OnTimeSyncResponse(data); });
+
+		m_server.OnCreateSpaceshipFailure.Connect([this](ServerConnection*, const Packets::CreateSpaceshipFailure& data)
+		{
+			// Accounts are reused between runs
+			if (data.reason == CreateSpaceshipFailureReason::AlreadyExists)
+				SpawnBots();
+			else
+				std::cerr << m_login << ": failed to create spaceship" << std::endl;
+		});
+
+		m_server.OnCreateSpaceshipSuccess.Connect([this](ServerConnection*, const Packets::CreateSpaceshipSuccess&) { SpawnBots(); });
+	}
+
+	bool LoadBot::Start(const Nz::String& serverHostname)
+	{
+		if (!m_server.Connect(serverHostname))
+		{
+			Fail("failed to connect to server");
+			return false;
+		}
+
+		ComputePassword();
+
+		m_status = Status::Connecting;
+		return true;
+	}
+
+	void LoadBot::Stop()
+	{
+		if (m_server.IsConnected())
+			m_server.Disconnect();
+	}
+
+	void LoadBot::Update(float elapsedTime)
+	{
+		switch (m_status)
+		{
+			case Status::Connecting:
+			{
+				// Wait for both the connection and the password hash before registering
+				if (m_isConnected && m_passwordFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+				{
+					m_passwordHash = m_passwordFuture.get();
+					if (m_passwordHash.empty())
+					{
+						Fail("failed to hash password");
+						break;
+					}
+
+					SendRegisterPacket();
+				}
+				break;
+			}
+
+			case Status::InArena:
+			{
+				m_movementAccumulator += elapsedTime;
+				m_movementTime += elapsedTime;
+				while (m_movementAccumulator >= m_settings.movementInterval)
+				{
+					m_movementAccumulator -= m_settings.movementInterval;
+					SendMovement();
+				}
+
+				m_timeSyncAccumulator += elapsedTime;
+				if (m_timeSyncAccumulator >= m_settings.timeSyncInterval)
+				{
+					m_timeSyncAccumulator -= m_settings.timeSyncInterval;
+					SendTimeSyncRequest();
+				}
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	void LoadBot::ComputePassword()
+	{
+		// Same hashing as LoginState, so accounts created here can also be used from the real client
+		const ConfigFile& config = m_server.GetApp().GetConfig();
+
+		int iCost = config.GetIntegerOption<int>("Security.Argon2.IterationCost");
+		int mCost = config.GetIntegerOption<int>("Security.Argon2.MemoryCost");
+		int tCost = config.GetIntegerOption<int>("Security.Argon2.ThreadCost");
+		int hashLength = config.GetIntegerOption<int>("Security.HashLength");
+		const std::string& salt = config.GetStringOption("Security.PasswordSalt");
+
+		Nz::String saltedPassword = Nz::String(m_login).ToLower() + m_settings.password;
+
+		m_passwordFuture = std::async(std::launch::async, [pwd = std::move(saltedPassword), &salt, iCost, mCost, tCost, hashLength]() -> std::string
+		{
+			std::string hash(hashLength, '\0');
+			if (argon2_hash(iCost, mCost, tCost, pwd.GetConstBuffer(), pwd.GetSize(), salt.data(), salt.size(), hash.data(), hash.size(), nullptr, 0, argon2_type::Argon2_id, ARGON2_VERSION_13) != ARGON2_OK)
+				hash.clear();
+
+			return hash;
+		});
+	}
+
+	void LoadBot::Fail(const std::string& reason)
+	{
+		std::cerr << m_login << ": " << reason << std::endl;
+
+		m_status = Status::Failed;
+		Stop();
+	}
+
+	void LoadBot::OnArenaState(const Packets::ArenaState& arenaState)
+	{
+		m_stats.arenaStateCount++;
+
+		// Acknowledge states like the real client does, so the server keeps delta-compressing them
+		Packets::ArenaStateAck ack;
+		ack.stateId = arenaState.stateId;
+
+		m_server.SendPacket(ack);
+	}
+
+	void LoadBot::OnConnected()
+	{
+		m_isConnected = true;
+	}
+
+	void LoadBot::OnDisconnected()
+	{
+		m_isConnected = false;
+
+		if (m_status != Status::Failed)
+			m_status = Status::Disconnected;
+	}
+
+	void LoadBot::OnHullList(const Packets::HullList& hullList)
+	{
+		m_hullList = hullList;
+		m_hasHullList = true;
+
+		TryCreateSpaceship();
+	}
+
+	void LoadBot::OnLoginFailure(const Packets::LoginFailure& loginFailure)
+	{
+		Fail("login failed (reason " + std::to_string(static_cast<int>(loginFailure.reason)) + ")");
+	}
+
+	void LoadBot::OnLoginSuccess()
+	{
+		m_status = Status::InArena;
+
+		Packets::JoinArena joinArena;
+		joinArena.arenaIndex = m_settings.arenaIndex;
+
+		m_server.SendPacket(joinArena);
+
+		// Movement packets carry a server time, synchronize clock before sending any
+		SendTimeSyncRequest();
+
+		if (m_settings.spawnedBotCount > 0)
+		{
+			m_server.SendPacket(Packets::QueryHullList());
+			m_server.SendPacket(Packets::QueryModuleList());
+		}
+	}
+
+	void LoadBot::OnModuleList(const Packets::ModuleList& moduleList)
+	{
+		m_moduleList = moduleList;
+		m_hasModuleList = true;
+
+		TryCreateSpaceship();
+	}
+
+	void LoadBot::OnRegisterFailure(const Packets::RegisterFailure& registerFailure)
+	{
+		// Accounts are reused between runs
+		if (registerFailure.reason == RegisterFailureReason::LoginAlreadyTaken)
+			SendLoginPacket();
+		else
+			Fail("register failed (reason " + std::to_string(static_cast<int>(registerFailure.reason)) + ")");
+	}
+
+	void LoadBot::OnTimeSyncResponse(const Packets::TimeSyncResponse& timeSyncResponse)
+	{
+		Nz::UInt64 appTime = ClientApplication::GetAppTime();
+		Nz::UInt64 roundTripTime = appTime - m_timeSyncRequestTimes[timeSyncResponse.requestId];
+
+		m_stats.latencyMax = std::max(m_stats.latencyMax, roundTripTime);
+		m_stats.latencySampleCount++;
+		m_stats.latencySum += roundTripTime;
+
+		// Unsigned wrap-around handles both server being older or younger than us
+		m_server.UpdateServerTimeDelta(timeSyncResponse.serverTime + roundTripTime / 2 - appTime);
+		m_isClockSynchronized = true;
+	}
+
+	void LoadBot::SendLoginPacket()
+	{
+		m_status = Status::LoggingIn;
+
+		Packets::Login loginPacket;
+		loginPacket.generateConnectionToken = false;
+		loginPacket.login = m_login;
+		loginPacket.passwordHash = m_passwordHash;
+
+		m_server.SendPacket(loginPacket);
+	}
+
+	void LoadBot::SendMovement()
+	{
+		if (!m_isClockSynchronized)
+			return;
+
+		Nz::UInt64 inputTime = m_server.EstimateServerTime();
+		if (!m_sentInputs.empty() && inputTime <= m_sentInputs.back().inputTime)
+			return;
+
+		// Wander around with smooth inputs, like a player steering would
+		SentInput sentInput;
+		sentInput.inputTime = inputTime;
+		sentInput.direction = Nz::Vector3f(std::sin(m_movementTime * 0.7f), 0.f, 1.f);
+		sentInput.rotation = Nz::Vector3f(0.f, std::sin(m_movementTime * 0.3f), std::cos(m_movementTime * 0.5f) * 0.2f);
+
+		m_sentInputs.push_back(sentInput); //< Overwrites the oldest one when full
+
+		Packets::PlayerMovement movementPacket;
+		movementPacket.inputTime = inputTime;
+
+		for (auto it = m_sentInputs.rbegin(); it != m_sentInputs.rend(); ++it)
+		{
+			auto& input = movementPacket.inputs.emplace_back();
+			input.timeOffset = static_cast<Nz::UInt32>(inputTime - it->inputTime);
+			input.direction = it->direction;
+			input.rotation = it->rotation;
+		}
+
+		m_server.SendPacket(movementPacket);
+
+		m_stats.movementCount++;
+	}
+
+	void LoadBot::SendRegisterPacket()
+	{
+		m_status = Status::Registering;
+
+		Packets::Register registerPacket;
+		registerPacket.email = m_login + "@loadtest.local";
+		registerPacket.login = m_login;
+		registerPacket.passwordHash = m_passwordHash;
+
+		m_server.SendPacket(registerPacket);
+	}
+
+	void LoadBot::SendTimeSyncRequest()
+	{
+		Packets::TimeSyncRequest timeSyncRequest;
+		timeSyncRequest.requestId = m_nextTimeSyncRequestId++;
+
+		m_timeSyncRequestTimes[timeSyncRequest.requestId] = ClientApplication::GetAppTime();
+		m_server.SendPacket(timeSyncRequest);
+	}
+
+	void LoadBot::SpawnBots()
+	{
+		Packets::PlayerChat chatPacket;
+		chatPacket.text = "/spawnbot " + m_settings.spaceshipName + " " + std::to_string(m_settings.spawnedBotCount);
+
+		m_server.SendPacket(chatPacket);
+	}
+
+	void LoadBot::TryCreateSpaceship()
+	{
+		if (!m_hasHullList || !m_hasModuleList)
+			return;
+
+		if (m_hullList.hulls.empty())
+		{
+			std::cerr << m_login << ": server has no hull, cannot spawn bots" << std::endl;
+			return;
+		}
+
+		// Server requires one module of every type, take the first one available
+		Packets::CreateSpaceship createSpaceship;
+		createSpaceship.hullId = m_hullList.hulls.front().hullId;
+		createSpaceship.spaceshipCode = m_settings.spaceshipCode;
+		createSpaceship.spaceshipName = m_settings.spaceshipName;
+
+		for (const auto& moduleType : m_moduleList.modules)
+		{
+			if (moduleType.availableModules.empty())
+				continue;
+
+			auto& moduleInfo = createSpaceship.modules.emplace_back();
+			moduleInfo.moduleId = moduleType.availableModules.front().moduleId;
+			moduleInfo.type = moduleType.type;
+		}
+
+		m_server.SendPacket(createSpaceship);
+	}
+}
@@ -0,0 +1,135 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon LoadTest" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_LOADTEST_LOADBOT_HPP
+#define EREWHON_LOADTEST_LOADBOT_HPP
+
+#include <Client/ServerConnection.hpp>
+#include <nonstd/ring_span.hpp>
+#include <array>
+#include <future>
+#include <string>
+
+namespace ewn
+{
+	class ClientApplication;
+
+	// Synthetic player, goes through the same packet flow as a real client without any rendering
+	class LoadBot
+	{
+		public:
+			struct Settings;
+			struct Stats;
+
+			enum class Status
+			{
+				Idle,
+				Connecting,
+				Registering,
+				LoggingIn,
+				InArena,
+				Disconnected,
+				Failed
+			};
+
+			LoadBot(ClientApplication& app, std::size_t botIndex, const Settings& settings);
+			LoadBot(const LoadBot&) = delete;
+			LoadBot(LoadBot&&) = delete;
+			~LoadBot() = default;
+
+			inline const std::string& GetLogin() const;
+			inline const ServerConnection& GetServer() const;
+			inline const Stats& GetStats() const;
+			inline Status GetStatus() const;
+
+			inline void ResetStats();
+
+			bool Start(const Nz::String& serverHostname);
+			void Stop();
+
+			void Update(float elapsedTime);
+
+			LoadBot& operator=(const LoadBot&) = delete;
+			LoadBot& operator=(LoadBot&&) = delete;
+
+			struct Settings
+			{
+				std::string loginPrefix;
+				std::string password;
+				std::string spaceshipCode;
+				std::string spaceshipName;
+				std::size_t spawnedBotCount;
+				float movementInterval;
+				float timeSyncInterval;
+				Nz::UInt8 arenaIndex;
+			};
+
+			struct Stats
+			{
+				Nz::UInt64 arenaStateCount = 0;
+				Nz::UInt64 latencyMax = 0;
+				Nz::UInt64 latencySampleCount = 0;
+				Nz::UInt64 latencySum = 0;
+				Nz::UInt64 movementCount = 0;
+			};
+
+		private:
+			void ComputePassword();
+			void Fail(const std::string& reason);
+
+			void OnArenaState(const Packets::ArenaState& arenaState);
+			void OnConnected();
+			void OnDisconnected();
+			void OnHullList(const Packets::HullList& hullList);
+			void OnLoginFailure(const Packets::LoginFailure& loginFailure);
+			void OnLoginSuccess();
+			void OnModuleList(const Packets::ModuleList& moduleList);
+			void OnRegisterFailure(const Packets::RegisterFailure& registerFailure);
+			void OnTimeSyncResponse(const Packets::TimeSyncResponse& timeSyncResponse);
+
+			void SendLoginPacket();
+			void SendMovement();
+			void SendRegisterPacket();
+			void SendTimeSyncRequest();
+			void SpawnBots();
+			void TryCreateSpaceship();
+
+			struct SentInput
+			{
+				Nz::UInt64 inputTime;
+				Nz::Vector3f direction;
+				Nz::Vector3f rotation;
+			};
+
+			// The client only repeats unacknowledged inputs, bots always send as many as it may (worst case for bandwidth)
+			static constexpr std::size_t RedundantInputCount = Packets::PlayerMovement::MaxInputCount;
+
+			std::array<Nz::UInt64, 256> m_timeSyncRequestTimes;
+			std::array<SentInput, RedundantInputCount> m_sentInputData;
+			std::future<std::string> m_passwordFuture;
+			std::string m_login;
+			std::string m_passwordHash;
+			const Settings& m_settings;
+			Packets::HullList m_hullList;
+			Packets::ModuleList m_moduleList;
+			ServerConnection m_server;
+			nonstd::ring_span<SentInput> m_sentInputs;
+			Stats m_stats;
+			Status m_status;
+			Nz::UInt8 m_nextTimeSyncRequestId;
+			bool m_hasHullList;
+			bool m_hasModuleList;
+			bool m_isClockSynchronized;
+			bool m_isConnected;
+			float m_movementAccumulator;
+			float m_movementTime;
+			float m_timeSyncAccumulator;
+	};
+}
+
+#include <LoadTest/LoadBot.inl>
+
+#endif // EREWHON_LOADTEST_LOADBOT_HPP
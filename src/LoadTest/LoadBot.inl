@@ -0,0 +1,33 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon LoadTest" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadTest/LoadBot.hpp>
+
+namespace ewn
+{
+	inline const std::string& LoadBot::GetLogin() const
+	{
+		return m_login;
+	}
+
+	inline const ServerConnection& LoadBot::GetServer() const
+	{
+		return m_server;
+	}
+
+	inline const LoadBot::Stats& LoadBot::GetStats() const
+	{
+		return m_stats;
+	}
+
+	inline LoadBot::Status LoadBot::GetStatus() const
+	{
+		return m_status;
+	}
+
+	inline void LoadBot::ResetStats()
+	{
+		m_stats = Stats();
+	}
+}
@@ -0,0 +1,200 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon LoadTest" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <Client/ClientApplication.hpp>
+#include <LoadTest/LoadBot.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+int main()
+{
+	constexpr std::size_t MaxClientCount = 1000;
+
+	Nz::Initializer<Nz::Network> nazaraInit;
+
+	ewn::ClientApplication app(MaxClientCount);
+
+	ewn::ConfigFile& config = app.GetConfig();
+	config.RegisterIntegerOption("LoadTest.ArenaIndex", 0, 0xFF);
+	config.RegisterIntegerOption("LoadTest.ClientCount", 1, MaxClientCount);
+	config.RegisterFloatOption("LoadTest.ConnectionRate", 0.1, 1000.0);
+	config.RegisterFloatOption("LoadTest.Duration", 0.0, 24.0 * 60.0 * 60.0);
+	config.RegisterStringOption("LoadTest.LoginPrefix");
+	config.RegisterFloatOption("LoadTest.MovementRate", 1.0, 1000.0);
+	config.RegisterStringOption("LoadTest.Password");
+	config.RegisterFloatOption("LoadTest.ReportInterval", 0.1, 3600.0);
+	config.RegisterIntegerOption("LoadTest.SpawnedBotCount", 0, 10);
+	config.RegisterStringOption("LoadTest.SpaceshipName");
+	config.RegisterFloatOption("LoadTest.TimeSyncInterval", 0.1, 60.0);
+
+	if (!app.LoadConfig("ltconfig.lua"))
+	{
+		std::cerr << "Failed to load config file" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	ewn::LoadBot::Settings settings;
+	settings.arenaIndex = config.GetIntegerOption<Nz::UInt8>("LoadTest.ArenaIndex");
+	settings.loginPrefix = config.GetStringOption("LoadTest.LoginPrefix");
+	settings.movementInterval = 1.f / config.GetFloatOption<float>("LoadTest.MovementRate");
+	settings.password = config.GetStringOption("LoadTest.Password");
+	settings.spaceshipName = config.GetStringOption("LoadTest.SpaceshipName");
+	settings.spawnedBotCount = config.GetIntegerOption<std::size_t>("LoadTest.SpawnedBotCount");
+	settings.timeSyncInterval = config.GetFloatOption<float>("LoadTest.TimeSyncInterval");
+
+	if (settings.spawnedBotCount > 0)
+	{
+		const std::string& scriptFile = config.GetStringOption("ServerScript.Filename");
+
+		std::ifstream file(scriptFile);
+		if (!file)
+		{
+			std::cerr << "Failed to open " << scriptFile << ", bots won't be spawned" << std::endl;
+			settings.spawnedBotCount = 0;
+		}
+		else
+		{
+			std::stringstream content;
+			content << file.rdbuf();
+
+			settings.spaceshipCode = content.str();
+		}
+	}
+
+	std::size_t clientCount = config.GetIntegerOption<std::size_t>("LoadTest.ClientCount");
+	float connectionInterval = 1.f / config.GetFloatOption<float>("LoadTest.ConnectionRate");
+	float duration = config.GetFloatOption<float>("LoadTest.Duration");
+	float reportInterval = config.GetFloatOption<float>("LoadTest.ReportInterval");
+	const std::string& serverAddress = config.GetStringOption("Server.Address");
+
+	std::vector<std::unique_ptr<ewn::LoadBot>> bots;
+	bots.reserve(clientCount);
+	for (std::size_t i = 0; i < clientCount; ++i)
+		bots.emplace_back(std::make_unique<ewn::LoadBot>(app, i, settings));
+
+	std::cout << "Starting " << clientCount << " client(s) against " << serverAddress << std::endl;
+
+	std::size_t nextBotIndex = 0;
+	float connectionAccumulator = connectionInterval; //< Start first client right away
+	float elapsedTotal = 0.f;
+	float reportAccumulator = 0.f;
+	float stopTime = 0.f;
+	bool isStopping = false;
+	Nz::UInt64 lastReceivedBytes = 0;
+	Nz::UInt64 lastSentBytes = 0;
+
+	while (app.Run())
+	{
+		float elapsedTime = app.GetUpdateTime();
+		elapsedTotal += elapsedTime;
+
+		// Ramp clients up progressively, a server doesn't usually see everyone logging in at once
+		if (!isStopping)
+		{
+			connectionAccumulator += elapsedTime;
+			while (connectionAccumulator >= connectionInterval && nextBotIndex < clientCount)
+			{
+				connectionAccumulator -= connectionInterval;
+				bots[nextBotIndex++]->Start(serverAddress);
+			}
+		}
+
+		for (const auto& bot : bots)
+			bot->Update(elapsedTime);
+
+		reportAccumulator += elapsedTime;
+		if (reportAccumulator >= reportInterval)
+		{
+			std::size_t inArenaCount = 0;
+			std::size_t pendingCount = 0;
+			std::size_t lostCount = 0;
+			Nz::UInt64 arenaStateCount = 0;
+			Nz::UInt64 latencyMax = 0;
+			Nz::UInt64 latencySampleCount = 0;
+			Nz::UInt64 latencySum = 0;
+			Nz::UInt64 movementCount = 0;
+			Nz::UInt64 receivedBytes = 0;
+			Nz::UInt64 sentBytes = 0;
+
+			for (const auto& bot : bots)
+			{
+				switch (bot->GetStatus())
+				{
+					case ewn::LoadBot::Status::Idle:
+						break;
+
+					case ewn::LoadBot::Status::Connecting:
+					case ewn::LoadBot::Status::Registering:
+					case ewn::LoadBot::Status::LoggingIn:
+						pendingCount++;
+						break;
+
+					case ewn::LoadBot::Status::InArena:
+						inArenaCount++;
+						break;
+
+					case ewn::LoadBot::Status::Disconnected:
+					case ewn::LoadBot::Status::Failed:
+						lostCount++;
+						break;
+				}
+
+				const ewn::LoadBot::Stats& stats = bot->GetStats();
+				arenaStateCount += stats.arenaStateCount;
+				latencyMax = std::max(latencyMax, stats.latencyMax);
+				latencySampleCount += stats.latencySampleCount;
+				latencySum += stats.latencySum;
+				movementCount += stats.movementCount;
+
+				receivedBytes += bot->GetServer().GetReceivedBytes();
+				sentBytes += bot->GetServer().GetSentBytes();
+
+				bot->ResetStats();
+			}
+
+			// Bandwidth is measured on message payloads, ENet headers and acknowledgements are not accounted for
+			float inKiBs = (receivedBytes - lastReceivedBytes) / 1024.f / reportAccumulator;
+			float outKiBs = (sentBytes - lastSentBytes) / 1024.f / reportAccumulator;
+
+			std::cout << "[" << elapsedTotal << "s] clients: " << inArenaCount << " in arena, " << pendingCount << " logging in, " << lostCount << " lost";
+			std::cout << " | rtt: " << ((latencySampleCount > 0) ? latencySum / latencySampleCount : 0) << "ms avg, " << latencyMax << "ms max";
+			std::cout << " | in: " << inKiBs << " KiB/s (" << arenaStateCount / reportAccumulator << " states/s)";
+			std::cout << " | out: " << outKiBs << " KiB/s (" << movementCount / reportAccumulator << " inputs/s)" << std::endl;
+
+			lastReceivedBytes = receivedBytes;
+			lastSentBytes = sentBytes;
+			reportAccumulator = 0.f;
+		}
+
+		if (!isStopping && duration > 0.f && elapsedTotal >= duration)
+		{
+			std::cout << "Test duration reached, disconnecting clients" << std::endl;
+
+			for (const auto& bot : bots)
+				bot->Stop();
+
+			isStopping = true;
+			stopTime = elapsedTotal;
+		}
+
+		if (isStopping)
+		{
+			// Give some time to disconnection packets to leave
+			bool allDisconnected = std::none_of(bots.begin(), bots.end(), [](const auto& bot) { return bot->GetServer().IsConnected(); });
+			if (allDisconnected || elapsedTotal - stopTime >= 5.f)
+				app.Quit();
+		}
+
+		// There's nothing to render, don't spin a core the server may need
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
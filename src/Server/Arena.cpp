@@ -9,6 +9,7 @@
 #include <NDK/Components/PhysicsComponent3D.hpp>
 #include <NDK/Systems/PhysicsSystem3D.hpp>
 #include <NDK/LuaAPI.hpp>
+#include <Shared/SpaceshipMovement.hpp>
 #include <Server/Player.hpp>
 #include <Server/ServerApplication.hpp>
 #include <Server/Components/ArenaComponent.hpp>
@@ -23,12 +24,15 @@
 #include <Server/Components/ScriptComponent.hpp>
 #include <Server/Components/SynchronizedComponent.hpp>
 #include <Server/Scripting/ArenaInterface.hpp>
+#include <Server/Systems/ArenaBoundsSystem.hpp>
 #include <Server/Systems/BroadcastSystem.hpp>
 #include <Server/Systems/LifeTimeSystem.hpp>
 #include <Server/Systems/NavigationSystem.hpp>
 #include <Server/Systems/ScriptSystem.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
 #include <Server/Systems/InputSystem.hpp>
 #include <cassert>
+#include <memory>
 #include <stdexcept>
 
 namespace ewn
@@ -37,21 +41,20 @@ namespace ewn
 
 	Arena::Arena(ServerApplication* app, std::string name, std::string scriptName) :
 	m_name(std::move(name)),
-	m_app(app),
-	m_stateBroadcastAccumulator(0.f)
+	m_commandStore(app->GetCommandStore()),
+	m_app(app)
 	{
-		auto& broadcastSystem = m_world.AddSystem<BroadcastSystem>();
+		auto& broadcastSystem = m_world.AddSystem<BroadcastSystem>(app);
 		broadcastSystem.BroadcastEntityCreation.Connect(this,    &Arena::OnBroadcastEntityCreation);
 		broadcastSystem.BroadcastEntityDestruction.Connect(this, &Arena::OnBroadcastEntityDestruction);
 		broadcastSystem.BroadcastStateUpdate.Connect(this,       &Arena::OnBroadcastStateUpdate);
 
-		if (sendServerGhosts)
-			broadcastSystem.SetMaximumUpdateRate(60.f);
-
+		m_world.AddSystem<ArenaBoundsSystem>();
 		m_world.AddSystem<InputSystem>();
 		m_world.AddSystem<LifeTimeSystem>();
 		m_world.AddSystem<NavigationSystem>();
 		m_world.AddSystem<ScriptSystem>(m_app, this);
+		m_world.AddSystem<SpatialSystem>();
 
 		Nz::PhysWorld3D& world = m_world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
 		int defaultMaterial = world.GetMaterial("default");
@@ -126,8 +129,7 @@ namespace ewn
 		Packets::ChatMessage chatPacket;
 		chatPacket.message = message.ToStdString();
 
-		for (Player* player : m_players)
-			player->SendPacket(chatPacket);
+		BroadcastPacket(chatPacket);
 	}
 
 	Player* Arena::FindPlayerByName(const std::string& name) const
@@ -157,181 +159,162 @@ namespace ewn
 			m_script.Pop();
 	}
 
+	void Arena::SetInterestRadius(float radius)
+	{
+		m_world.GetSystem<BroadcastSystem>().SetInterestRadius(radius);
+	}
+
 	void Arena::SpawnFleet(Player* owner, const std::string& fleetName)
 	{
-		m_app->GetGlobalDatabase().ExecuteQuery("FindFleetByOwnerIdAndName", { owner->GetDatabaseId(), fleetName }, [this, fleetName, sessionId = owner->GetSessionId()](DatabaseResult& result)
+		// The spaceship cache lives on the main thread, spawning is then handled by the arena during its update
+		m_app->RegisterCallback([this, ownerId = owner->GetDatabaseId(), fleetName, sessionId = owner->GetSessionId()]()
 		{
-			if (!result)
-			{
-				if (Player* ply = m_app->GetPlayerBySession(sessionId))
-					ply->PrintMessage("An error occurred");
-
-				std::cerr << "FindFleetByOwnerIdAndName failed: " << result.GetLastErrorMessage() << std::endl;
-				return;
-			}
-
-			Player* ply = m_app->GetPlayerBySession(sessionId);
-			if (!ply)
+			// The cache only holds rows of connected accounts
+			if (!m_app->GetPlayerBySession(sessionId))
 				return;
 
-			if (result.GetRowCount() == 0)
+			m_app->GetSpaceshipCache().FindFleet(ownerId, fleetName, [this, fleetName, sessionId](bool succeeded, const SpaceshipCache::Fleet* fleet)
 			{
-				ply->PrintMessage("Fleet " + fleetName + " not found");
-				return;
-			}
-
-			Nz::Int32 fleetId = std::get<Nz::Int32>(result.GetValue(0));
-
-			m_app->GetGlobalDatabase().ExecuteQuery("FindFleetSpaceshipsByFleetId", { fleetId }, [this, fleetName, sessionId](DatabaseResult& result)
-			{
-				if (!result)
-				{
-					if (Player* ply = m_app->GetPlayerBySession(sessionId))
-						ply->PrintMessage("An error occurred");
-
-					std::cerr << "FindFleetSpaceshipByFleetId failed: " << result.GetLastErrorMessage() << std::endl;
-					return;
-				}
-
 				Player* ply = m_app->GetPlayerBySession(sessionId);
 				if (!ply)
 					return;
 
-				std::size_t rowCount = result.GetRowCount();
-				if (rowCount == 0)
+				if (!succeeded)
 				{
-					ply->PrintMessage("An error occurred: fleet " + fleetName + " has no spaceship");
+					ply->PrintMessage("Server: Failed to retrieve fleet spaceships, please contact an administrator");
 					return;
 				}
 
-				Nz::Vector3f spawnPos;
-				Nz::Quaternionf spawnRot;
-				if (const Ndk::EntityHandle& spaceship = ply->GetControlledEntity(); spaceship != Ndk::EntityHandle::InvalidHandle)
+				if (!fleet)
 				{
-					Ndk::NodeComponent& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
-
-					spawnRot = spaceshipNode.GetRotation();
-					spawnPos = spaceshipNode.GetPosition() + spawnRot * Nz::Vector3f::Down() * 10.f;
+					ply->PrintMessage("Fleet " + fleetName + " not found");
+					return;
 				}
-				else
+
+				if (fleet->spaceships.empty())
 				{
-					spawnPos = Nz::Vector3f::Zero();
-					spawnRot = Nz::Quaternionf::Identity();
+					ply->PrintMessage("An error occurred: fleet " + fleetName + " has no spaceship");
+					return;
 				}
 
-				for (std::size_t i = 0; i < rowCount; ++i)
+				PostCommand([this, sessionId, fleetSpaceships = fleet->spaceships]()
 				{
-					Nz::Int32 spaceshipId = std::get<Nz::Int32>(result.GetValue(0));
-					Nz::Int16 spaceshipCount = std::get<Nz::Int16>(result.GetValue(1));
-					std::string name = std::get<std::string>(result.GetValue(2));
-					std::string script = std::get<std::string>(result.GetValue(3));
-					Nz::Int32 spaceshipHullId = std::get<Nz::Int32>(result.GetValue(4));
+					Player* player = m_app->GetPlayerBySession(sessionId);
+					if (!player || player->GetArena() != this)
+						return;
 
-					std::size_t collisionMeshId = m_app->GetSpaceshipHullStore().GetEntryCollisionMeshId(spaceshipHullId);
-					const Nz::Boxf& dimensions = m_app->GetCollisionMeshStore().GetEntryDimensions(collisionMeshId);
-
-					m_app->GetGlobalDatabase().ExecuteQuery("FindSpaceshipModulesBySpaceshipId", { spaceshipId }, [this, spawnPos, spawnRot, offset = dimensions.width, sessionId, spaceshipCount, spaceshipName = std::move(name), spaceshipScript = std::move(script), spaceshipHullId](ewn::DatabaseResult& result)
+					Nz::Vector3f spawnPos;
+					Nz::Quaternionf spawnRot;
+					if (const Ndk::EntityHandle& spaceship = player->GetControlledEntity(); spaceship != Ndk::EntityHandle::InvalidHandle)
 					{
-						Player* ply = m_app->GetPlayerBySession(sessionId);
-						if (!ply)
-							return;
-
-						if (!result)
-						{
-							ply->PrintMessage("Server: Failed to retrieve spaceship modules, please contact an administrator");
-							return;
-						}
+						Ndk::NodeComponent& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
 
-						std::size_t moduleCount = result.GetRowCount();
-
-						std::vector<std::size_t> moduleIds(moduleCount);
-						try
-						{
-							for (std::size_t i = 0; i < moduleCount; ++i)
-								moduleIds[i] = static_cast<std::size_t>(std::get<Nz::Int32>(result.GetValue(0, i)));
-						}
-						catch (const std::exception& e)
-						{
-							std::cerr << "Failed to retrieve spaceship modules: " << e.what() << std::endl;
+						spawnRot = spaceshipNode.GetRotation();
+						spawnPos = spaceshipNode.GetPosition() + spawnRot * Nz::Vector3f::Down() * 10.f;
+					}
+					else
+					{
+						spawnPos = Nz::Vector3f::Zero();
+						spawnRot = Nz::Quaternionf::Identity();
+					}
 
-							ply->PrintMessage("Server: Failed to retrieve spaceship modules, please contact an administrator");
-							return;
-						}
+					for (const SpaceshipCache::Fleet::Entry& fleetSpaceship : fleetSpaceships)
+					{
+						std::size_t collisionMeshId = m_app->GetSpaceshipHullStore().GetEntryCollisionMeshId(fleetSpaceship.hullId);
+						const Nz::Boxf& dimensions = m_app->GetCollisionMeshStore().GetEntryDimensions(collisionMeshId);
 
 						Nz::Vector3f pos = spawnPos;
-						for (Nz::Int16 j = 0; j < spaceshipCount; ++j)
+						for (Nz::Int16 j = 0; j < fleetSpaceship.count; ++j)
 						{
-							SpawnSpaceship(ply, spaceshipScript, spaceshipHullId, moduleIds, pos, spawnRot);
+							SpawnSpaceship(player, fleetSpaceship.script, fleetSpaceship.hullId, fleetSpaceship.moduleIds, pos, spawnRot);
 
-							pos += spawnRot * Nz::Vector3f::Left() * offset;
+							pos += spawnRot * Nz::Vector3f::Left() * dimensions.width;
 						}
-					});
 
-					spawnPos += spawnRot * Nz::Vector3f::Backward() * dimensions.depth;
-				}
+						spawnPos += spawnRot * Nz::Vector3f::Backward() * dimensions.depth;
+					}
+				});
 			});
 		});
 	}
 
 	void Arena::SpawnSpaceship(Player* owner, const std::string& spaceshipName, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
 	{
-		m_app->GetGlobalDatabase().ExecuteQuery("FindSpaceshipByOwnerIdAndName", { owner->GetDatabaseId(), spaceshipName }, [=, sessionId = owner->GetSessionId()](DatabaseResult& result)
+		// The spaceship cache lives on the main thread, spawning is then handled by the arena during its update
+		m_app->RegisterCallback([=, ownerId = owner->GetDatabaseId(), sessionId = owner->GetSessionId()]()
 		{
-			if (!result)
-				std::cerr << "Find spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
-
-			Player* ply = m_app->GetPlayerBySession(sessionId);
-			if (!ply)
+			// The cache only holds rows of connected accounts
+			if (!m_app->GetPlayerBySession(sessionId))
 				return;
 
-			if (!result)
+			m_app->GetSpaceshipCache().FindSpaceship(ownerId, spaceshipName, [=](bool succeeded, const SpaceshipCache::Spaceship* spaceship)
 			{
-				ply->PrintMessage("Failed to spawn spaceship \"" + spaceshipName + "\", please contact an admin");
-				return;
-			}
+				Player* ply = m_app->GetPlayerBySession(sessionId);
+				if (!ply)
+					return;
 
-			if (result.GetRowCount() == 0)
-			{
-				ply->PrintMessage("You have no spaceship named \"" + spaceshipName + "\"");
-				return;
-			}
+				if (!succeeded)
+				{
+					ply->PrintMessage("Failed to spawn spaceship \"" + spaceshipName + "\", please contact an admin");
+					return;
+				}
 
-			Nz::Int32 spaceshipId = std::get<Nz::Int32>(result.GetValue(0));
-			std::string code = std::get<std::string>(result.GetValue(1));
-			Nz::Int32 spaceshipHullId = std::get<Nz::Int32>(result.GetValue(2));
+				if (!spaceship)
+				{
+					ply->PrintMessage("You have no spaceship named \"" + spaceshipName + "\"");
+					return;
+				}
 
-			SpawnSpaceship(ply, spaceshipId, std::move(code), spaceshipHullId, position, rotation);
+				PostCommand([=, spaceshipData = *spaceship]()
+				{
+					Player* player = m_app->GetPlayerBySession(sessionId);
+					if (player && player->GetArena() == this)
+						SpawnSpaceship(player, spaceshipData.script, spaceshipData.hullId, spaceshipData.moduleIds, position, rotation);
+				});
+			});
 		});
 	}
 
 	void Arena::SpawnSpaceship(Player* owner, Nz::Int32 spaceshipId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
 	{
-		m_app->GetGlobalDatabase().ExecuteQuery("FindSpaceshipByIdAndOwnerId", { spaceshipId, owner->GetDatabaseId() }, [=, sessionId = owner->GetSessionId()](DatabaseResult& result)
+		// The spaceship cache lives on the main thread, spawning is then handled by the arena during its update
+		m_app->RegisterCallback([=, ownerId = owner->GetDatabaseId(), sessionId = owner->GetSessionId()]()
 		{
-			if (!result)
-				std::cerr << "Find spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
-
-			Player* ply = m_app->GetPlayerBySession(sessionId);
-			if (!ply)
+			// The cache only holds rows of connected accounts
+			if (!m_app->GetPlayerBySession(sessionId))
 				return;
 
-			if (!result || result.GetRowCount() == 0)
+			m_app->GetSpaceshipCache().FindSpaceship(ownerId, spaceshipId, [=](bool succeeded, const SpaceshipCache::Spaceship* spaceship)
 			{
-				ply->PrintMessage("Failed to spawn spaceship id " + std::to_string(spaceshipId) + ", please contact an admin");
-				return;
-			}
+				Player* ply = m_app->GetPlayerBySession(sessionId);
+				if (!ply)
+					return;
 
-			std::string code = std::get<std::string>(result.GetValue(1));
-			Nz::Int32 spaceshipHullId = std::get<Nz::Int32>(result.GetValue(2));
+				if (!succeeded || !spaceship)
+				{
+					ply->PrintMessage("Failed to spawn spaceship id " + std::to_string(spaceshipId) + ", please contact an admin");
+					return;
+				}
 
-			SpawnSpaceship(ply, spaceshipId, std::move(code), spaceshipHullId, position, rotation);
+				PostCommand([=, spaceshipData = *spaceship]()
+				{
+					Player* player = m_app->GetPlayerBySession(sessionId);
+					if (player && player->GetArena() == this)
+						SpawnSpaceship(player, spaceshipData.script, spaceshipData.hullId, spaceshipData.moduleIds, position, rotation);
+				});
+			});
 		});
 	}
 
 	void Arena::Update(float elapsedTime)
 	{
+		ProcessCommands();
+
 		m_world.Update(elapsedTime);
 
+		if constexpr (sendServerGhosts)
+			SendServerGhosts();
+
 		if (m_script.GetGlobal("OnUpdate") == Nz::LuaType_Function)
 		{
 			m_script.Push(elapsedTime);
@@ -341,12 +324,13 @@ namespace ewn
 		}
 		else
 			m_script.Pop();
-
-		m_stateBroadcastAccumulator += elapsedTime;
 	}
 
-	const Ndk::EntityHandle& Arena::CreateEntity(std::string type, std::string name, Player* owner, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
+	const Ndk::EntityHandle& Arena::CreateEntity(std::string type, std::string name, Player* owner, const Nz::Vector3f& unboundedPosition, const Nz::Quaternionf& rotation)
 	{
+		// Static entities are not handled by ArenaBoundsSystem, keep everything inside the arena from the start
+		Nz::Vector3f position(Nz::Clamp(unboundedPosition.x, -ArenaExtent, ArenaExtent), Nz::Clamp(unboundedPosition.y, -ArenaExtent, ArenaExtent), Nz::Clamp(unboundedPosition.z, -ArenaExtent, ArenaExtent));
+
 		const Ndk::EntityHandle& newEntity = m_world.CreateEntity();
 
 		if (type == "earth")
@@ -449,12 +433,19 @@ namespace ewn
 		Nz::Collider3DRef collider = m_app->GetCollisionMeshStore().GetEntryCollider(collisionMeshId);
 		assert(collider);
 
+		// Store colliders are shared by all arenas and lazily create their per-world handle
+		std::unique_lock<std::mutex> colliderLock(s_colliderMutex);
+
 		auto& collisionComponent = newEntity->AddComponent<Ndk::CollisionComponent3D>(collider);
 
 		auto& physComponent = newEntity->AddComponent<Ndk::PhysicsComponent3D>();
-		physComponent.SetMass(42.f);
-		physComponent.SetAngularDamping(Nz::Vector3f(0.4f));
-		physComponent.SetLinearDamping(0.25f);
+
+		colliderLock.unlock();
+
+		// Client-side prediction relies on those
+		physComponent.SetMass(SpaceshipMovement::Mass);
+		physComponent.SetAngularDamping(Nz::Vector3f(SpaceshipMovement::AngularDamping));
+		physComponent.SetLinearDamping(SpaceshipMovement::LinearDamping);
 		physComponent.SetPosition(position);
 		physComponent.SetRotation(rotation);
 
@@ -580,6 +571,8 @@ namespace ewn
 
 		player->ClearControlledEntity();
 		m_players.erase(player);
+
+		m_world.GetSystem<BroadcastSystem>().RemovePlayer(player);
 	}
 
 	void Arena::HandlePlayerJoin(Player* player)
@@ -588,11 +581,8 @@ namespace ewn
 
 		SendArenaData(player);
 
-		m_createEntityCache.clear();
-		m_world.GetSystem<BroadcastSystem>().CreateAllEntities(m_createEntityCache);
-
-		for (const auto& packet : m_createEntityCache)
-			player->SendPacket(packet);
+		// Entities are then streamed to the player depending on their relevance
+		m_world.GetSystem<BroadcastSystem>().AddPlayer(player);
 
 		m_players.insert(player);
 
@@ -607,7 +597,60 @@ namespace ewn
 			m_script.Pop();
 	}
 
+	void Arena::ProcessCommands()
+	{
+		Command command;
+		while (m_commandQueue.try_dequeue(command))
+			command();
+	}
+
 	void Arena::SendArenaData(Player* player)
+	{
+		// Arena data is the same for every player, serialize it once
+		if (!m_arenaPrefabsPacket)
+			BuildArenaData();
+
+		player->SendSharedPacket<Packets::ArenaParticleSystems>(m_arenaParticleSystemsPacket);
+		player->SendSharedPacket<Packets::ArenaSounds>(m_arenaSoundsPacket);
+		player->SendSharedPacket<Packets::ArenaPrefabs>(m_arenaPrefabsPacket);
+	}
+
+	void Arena::SendServerGhosts()
+	{
+		// Broadcast the whole arena state over network once per tick, for testing purposes
+		Packets::ArenaState ghostState;
+		ghostState.stateId = 0;
+		ghostState.baselineId = 0;
+		ghostState.serverTime = ServerApplication::GetAppTime();
+		ghostState.lastProcessedInputTime = 0;
+
+		for (const Ndk::EntityHandle& entity : m_world.GetEntities())
+		{
+			if (!entity->HasComponent<SynchronizedComponent>() || !entity->HasComponent<Ndk::PhysicsComponent3D>())
+				continue;
+
+			auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+			Packets::ArenaState::Entity& entityData = ghostState.entities.emplace_back();
+			entityData.id = entity->GetId();
+			entityData.fields = Packets::ArenaState::EntityField_All;
+			entityData.angularVelocity = entityPhys.GetAngularVelocity();
+			entityData.linearVelocity = entityPhys.GetLinearVelocity();
+			entityData.position = entityPhys.GetPosition();
+			entityData.rotation = entityPhys.GetRotation();
+		}
+
+		Nz::NetPacket debugState(1);
+		PacketSerializer serializer(debugState, true);
+		Packets::Serialize(serializer, ghostState);
+
+		Nz::IpAddress debugAddress = Nz::IpAddress::BroadcastIpV4;
+		debugAddress.SetPort(2050);
+
+		m_debugSocket.SendPacket(debugAddress, debugState);
+	}
+
+	void Arena::BuildArenaData()
 	{
 		Packets::ArenaParticleSystems arenaParticleSystems;
 		arenaParticleSystems.startId = 0;
@@ -622,7 +665,7 @@ namespace ewn
 		arenaParticleSystems.particleSystems.back().particleGroups.emplace_back();
 		arenaParticleSystems.particleSystems.back().particleGroups.back().particleGroupNameId = m_app->GetNetworkStringStore().GetStringIndex("explosion_wave");
 
-		player->SendPacket(arenaParticleSystems);
+		m_arenaParticleSystemsPacket = SerializeSharedPacket(arenaParticleSystems);
 
 		Packets::ArenaSounds arenaSoundsPacket;
 		arenaSoundsPacket.startId = 0;
@@ -636,7 +679,7 @@ namespace ewn
 		arenaSoundsPacket.sounds.emplace_back();
 		arenaSoundsPacket.sounds.back().filePath = "sounds/spaceship_explosion.wav";
 
-		player->SendPacket(arenaSoundsPacket);
+		m_arenaSoundsPacket = SerializeSharedPacket(arenaSoundsPacket);
 
 		Packets::ArenaPrefabs arenaPrefabsPacket;
 		arenaPrefabsPacket.startId = 0;
@@ -701,44 +744,7 @@ namespace ewn
 		arenaPrefabsPacket.prefabs.back().models.back().rotation = Nz::EulerAnglesf(0.f, 90.f, 0.f);
 		arenaPrefabsPacket.prefabs.back().models.back().scale = Nz::Vector3f(20.f);
 
-		player->SendPacket(arenaPrefabsPacket);
-	}
-
-	void Arena::SpawnSpaceship(Player* owner, Nz::Int32 spaceshipId, std::string code, std::size_t spaceshipHullId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
-	{
-		m_app->GetGlobalDatabase().ExecuteQuery("FindSpaceshipModulesBySpaceshipId", { spaceshipId }, [this, position, rotation, sessionId = owner->GetSessionId(), spaceshipHullId, spaceshipCode = std::move(code)](DatabaseResult& result)
-		{
-			if (!result)
-				std::cerr << "Find spaceship modules failed: " << result.GetLastErrorMessage() << std::endl;
-
-			Player* ply = m_app->GetPlayerBySession(sessionId);
-			if (!ply)
-				return;
-
-			if (!result)
-			{
-				ply->PrintMessage("Server: Failed to retrieve spaceship modules, please contact an administrator");
-				return;
-			}
-
-			std::size_t moduleCount = result.GetRowCount();
-
-			std::vector<std::size_t> moduleIds(moduleCount);
-			try
-			{
-				for (std::size_t i = 0; i < moduleCount; ++i)
-					moduleIds[i] = static_cast<std::size_t>(std::get<Nz::Int32>(result.GetValue(0, i)));
-			}
-			catch (const std::exception& e)
-			{
-				std::cerr << "Failed to retrieve spaceship modules: " << e.what() << std::endl;
-
-				ply->PrintMessage("Server: Failed to retrieve spaceship modules, please contact an administrator");
-				return;
-			}
-
-			SpawnSpaceship(ply, std::move(spaceshipCode), spaceshipHullId, moduleIds, position, rotation);
-		});
+		m_arenaPrefabsPacket = SerializeSharedPacket(arenaPrefabsPacket);
 	}
 
 	void Arena::SpawnSpaceship(Player* owner, std::string code, std::size_t spaceshipHullId, const std::vector<std::size_t>& modules, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
@@ -865,85 +871,52 @@ namespace ewn
 		// Apply physics force
 		auto& projectilePhys = projectile->GetComponent<Ndk::PhysicsComponent3D>();
 
-		Nz::PhysWorld3D& physWorld = m_world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
-
 		float explosionRadius = 50.f;
 		Nz::Vector3f torpedoPosition = projectilePhys.GetPosition();
-		Nz::Boxf detectionBox = Nz::Boxf(torpedoPosition - Nz::Vector3f(explosionRadius), torpedoPosition + Nz::Vector3f(explosionRadius));
 
-		float maxSquaredRadius = explosionRadius * explosionRadius;
-		physWorld.ForEachBodyInAABB(detectionBox, [&](Nz::RigidBody3D& body)
-		{
-			Nz::Vector3f bodyPosition = body.GetPosition();
-			if (bodyPosition.SquaredDistance(torpedoPosition) < maxSquaredRadius)
-			{
-				Ndk::EntityId bodyId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(body.GetUserdata()));
-				const Ndk::EntityHandle& bodyEntity = m_world.GetEntity(bodyId);
+		m_explosionTargets.clear();
+		m_world.GetSystem<SpatialSystem>().QuerySphere(torpedoPosition, explosionRadius, m_explosionTargets);
 
-				float fade = std::clamp(bodyPosition.Distance(torpedoPosition) / explosionRadius, 0.f, 1.f);
-
-				if (bodyEntity->HasComponent<HealthComponent>())
-				{
-					auto& health = bodyEntity->GetComponent<HealthComponent>();
-					health.Damage(static_cast<Nz::UInt16>(projectileComponent.GetDamageValue() / fade), projectile);
-				}
+		for (const SpatialSystem::Entry& target : m_explosionTargets)
+		{
+			const Ndk::EntityHandle& targetEntity = m_world.GetEntity(target.entityId);
 
-				Nz::Vector3f force = bodyPosition - torpedoPosition;
-				force.Normalize();
-				force *= 500'000.f / fade;
+			float fade = std::clamp(target.position.Distance(torpedoPosition) / explosionRadius, 0.f, 1.f);
 
-				body.AddForce(force);
+			if (targetEntity->HasComponent<HealthComponent>())
+			{
+				auto& health = targetEntity->GetComponent<HealthComponent>();
+				health.Damage(static_cast<Nz::UInt16>(projectileComponent.GetDamageValue() / fade), projectile);
 			}
 
-			return true;
-		});
+			Nz::Vector3f force = target.position - torpedoPosition;
+			force.Normalize();
+			force *= 500'000.f / fade;
+
+			targetEntity->GetComponent<Ndk::PhysicsComponent3D>().AddForce(force);
+		}
 
 		projectile->Kill(); //< Remember entity destruction is not immediate, we can still use it safely
 
 		return false;
 	}
 
-	void Arena::OnBroadcastEntityCreation(const BroadcastSystem* /*system*/, const Packets::CreateEntity& packet)
+	void Arena::OnBroadcastEntityCreation(const BroadcastSystem* /*system*/, Player* player, const NetworkReactor::SharedPacket& createPacket)
 	{
-		for (Player* player : m_players)
-			player->SendPacket(packet);
+		player->SendSharedPacket<Packets::CreateEntity>(createPacket);
 	}
 
-	void Arena::OnBroadcastEntityDestruction(const BroadcastSystem* /*system*/, const Packets::DeleteEntity& packet)
+	void Arena::OnBroadcastEntityDestruction(const BroadcastSystem* /*system*/, Player* player, const NetworkReactor::SharedPacket& deletePacket)
 	{
-		for (Player* player : m_players)
-			player->SendPacket(packet);
+		player->SendSharedPacket<Packets::DeleteEntity>(deletePacket);
 	}
 
-	void Arena::OnBroadcastStateUpdate(const BroadcastSystem* /*system*/, Packets::ArenaState& statePacket)
+	void Arena::OnBroadcastStateUpdate(const BroadcastSystem* /*system*/, Player* player, Packets::ArenaState& statePacket)
 	{
-		constexpr float stateBroadcastInterval = 1.f / 30.f;
-		if (m_stateBroadcastAccumulator >= stateBroadcastInterval)
-		{
-			m_stateBroadcastAccumulator -= stateBroadcastInterval;
+		statePacket.lastProcessedInputTime = player->GetLastInputProcessedTime();
 
-			static Nz::UInt16 snapshotId = 0;
-			statePacket.stateId = snapshotId++;
-
-			for (Player* player : m_players)
-			{
-				statePacket.lastProcessedInputTime = player->GetLastInputProcessedTime();
-
-				player->SendPacket(statePacket);
-			}
-		}
-
-		if constexpr (sendServerGhosts)
-		{
-			// Broadcast arena state over network, for testing purposes
-			Nz::NetPacket debugState(1);
-			PacketSerializer serializer(debugState, true);
-			Packets::Serialize(serializer, statePacket);
-
-			Nz::IpAddress debugAddress = Nz::IpAddress::BroadcastIpV4;
-			debugAddress.SetPort(2050);
-
-			m_debugSocket.SendPacket(debugAddress, debugState);
-		}
+		player->SendPacket(statePacket);
 	}
+
+	std::mutex Arena::s_colliderMutex;
 }
@@ -15,6 +15,10 @@
 #include <Shared/NetworkReactor.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Server/ServerCommandStore.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
+#include <concurrentqueue/concurrentqueue.h>
+#include <functional>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 
@@ -34,6 +38,8 @@ namespace ewn
 		friend Player;
 
 		public:
+			using Command = std::function<void()>;
+
 			Arena(ServerApplication* app, std::string name, std::string scriptName);
 			Arena(const Arena&) = delete;
 			Arena(Arena&&) = delete;
@@ -54,12 +60,15 @@ namespace ewn
 
 			inline const std::string& GetName() const;
 
+			inline void PostCommand(Command command);
+
 			void Reset();
 
+			void SetInterestRadius(float radius);
+
 			void SpawnFleet(Player* owner, const std::string& fleetName);
 			void SpawnSpaceship(Player* owner, const std::string& spaceshipName, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 			void SpawnSpaceship(Player* owner, Nz::Int32 spaceshipId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
-			void SpawnSpaceship(Player* owner, Nz::Int32 spaceshipId, std::string code, std::size_t spaceshipHullId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 			void SpawnSpaceship(Player* owner, std::string code, std::size_t spaceshipHullId, const std::vector<std::size_t>& modules, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 
 			void Update(float elapsedTime);
@@ -68,6 +77,10 @@ namespace ewn
 			Arena& operator=(Arena&&) = delete;
 
 		private:
+			using CommandQueue = moodycamel::ConcurrentQueue<Command>;
+
+			void BuildArenaData();
+
 			void LoadScript(std::string fileName);
 
 			void HandlePlayerLeave(Player* player);
@@ -77,11 +90,18 @@ namespace ewn
 			bool HandlePlasmaProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody);
 			bool HandleTorpedoProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody);
 
-			void OnBroadcastEntityCreation(const BroadcastSystem* system, const Packets::CreateEntity& packet);
-			void OnBroadcastEntityDestruction(const BroadcastSystem* system, const Packets::DeleteEntity& packet);
-			void OnBroadcastStateUpdate(const BroadcastSystem* system, Packets::ArenaState& statePacket);
+			void OnBroadcastEntityCreation(const BroadcastSystem* system, Player* player, const NetworkReactor::SharedPacket& createPacket);
+			void OnBroadcastEntityDestruction(const BroadcastSystem* system, Player* player, const NetworkReactor::SharedPacket& deletePacket);
+			void OnBroadcastStateUpdate(const BroadcastSystem* system, Player* player, Packets::ArenaState& statePacket);
+
+			void ProcessCommands();
 
 			void SendArenaData(Player* player);
+			void SendServerGhosts();
+
+			template<typename T> NetworkReactor::SharedPacket SerializeSharedPacket(const T& packet) const;
+
+			static std::mutex s_colliderMutex;
 
 			Nz::LuaInstance m_script;
 			Nz::UdpSocket m_debugSocket;
@@ -89,9 +109,13 @@ namespace ewn
 			Ndk::World m_world;
 			std::string m_name;
 			std::unordered_set<Player*> m_players;
-			std::vector<Packets::CreateEntity> m_createEntityCache;
+			std::vector<SpatialSystem::Entry> m_explosionTargets;
+			CommandQueue m_commandQueue;
+			NetworkReactor::SharedPacket m_arenaParticleSystemsPacket;
+			NetworkReactor::SharedPacket m_arenaPrefabsPacket;
+			NetworkReactor::SharedPacket m_arenaSoundsPacket;
+			const ServerCommandStore& m_commandStore;
 			ServerApplication* m_app;
-			float m_stateBroadcastAccumulator;
 			int m_plasmaMaterial;
 			int m_torpedoMaterial;
 	};
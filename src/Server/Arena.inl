@@ -10,10 +10,12 @@ namespace ewn
 	template<typename T>
 	void Arena::BroadcastPacket(const T& packet, Player* exceptPlayer)
 	{
+		NetworkReactor::SharedPacket sharedPacket = SerializeSharedPacket(packet);
+
 		for (Player* player : m_players)
 		{
 			if (player != exceptPlayer)
-				player->SendPacket(packet);
+				player->SendSharedPacket<T>(sharedPacket);
 		}
 	}
 
@@ -21,4 +23,18 @@ namespace ewn
 	{
 		return m_name;
 	}
+
+	inline void Arena::PostCommand(Command command)
+	{
+		m_commandQueue.enqueue(std::move(command));
+	}
+
+	template<typename T>
+	NetworkReactor::SharedPacket Arena::SerializeSharedPacket(const T& packet) const
+	{
+		std::shared_ptr<Nz::NetPacket> sharedPacket = std::make_shared<Nz::NetPacket>();
+		m_commandStore.SerializePacket(*sharedPacket, packet);
+
+		return sharedPacket;
+	}
 }
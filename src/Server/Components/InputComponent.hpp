@@ -9,6 +9,7 @@
 
 #include <Nazara/Math/Vector3.hpp>
 #include <NDK/Component.hpp>
+#include <Shared/SpaceshipMovement.hpp>
 #include <Server/Player.hpp>
 
 namespace ewn
@@ -31,7 +31,10 @@ namespace ewn
 
 	inline void InputComponent::PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& movement, const Nz::Vector3f& rotation)
 	{
-		assert(inputTime > m_lastInputTime);
+		// Inputs are sent more than once, only keep new ones
+		if (inputTime <= m_lastInputTime || (!m_inputs.empty() && inputTime <= m_inputs.back().serverTime))
+			return;
+
 		assert(movement.x >= -1.f && movement.x <= 1.f);
 		assert(movement.y >= -1.f && movement.y <= 1.f);
 		assert(movement.z >= -1.f && movement.z <= 1.f);
@@ -41,8 +44,8 @@ namespace ewn
 
 		InputData inputData;
 		inputData.serverTime = inputTime;
-		inputData.direction = movement * 50.f;
-		inputData.rotation = rotation * 200.f;
+		inputData.direction = movement * SpaceshipMovement::MovementScale;
+		inputData.rotation = rotation * SpaceshipMovement::RotationScale;
 
 		m_inputs.emplace_back(std::move(inputData));
 	}
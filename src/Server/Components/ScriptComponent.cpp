@@ -15,8 +15,10 @@
 #include <Server/Modules/NavigationModule.hpp>
 #include <Server/Modules/RadarModule.hpp>
 #include <Server/Modules/WeaponModule.hpp>
+#include <Server/Scripting/ScriptStatePool.hpp>
 #include <Server/Store/ModuleStore.hpp>
 #include <iostream>
+#include <stdexcept>
 
 namespace ewn
 {
@@ -24,41 +26,30 @@ namespace ewn
 	m_lastMessageTime(0),
 	m_tickCounter(0.f)
 	{
-		m_instance.SetMemoryLimit(1'000'000);
-		m_instance.SetTimeLimit(50);
-
-		m_instance.LoadLibraries(Nz::LuaLib_Math | Nz::LuaLib_String | Nz::LuaLib_Table | Nz::LuaLib_Utf8);
-
-		m_instance.PushNil();
-		m_instance.SetGlobal("collectgarbage");
-
-		m_instance.PushNil();
-		m_instance.SetGlobal("dofile");
-
-		m_instance.PushNil();
-		m_instance.SetGlobal("loadfile");
+		m_instance = ScriptStatePool::Acquire();
+		if (!m_instance)
+			throw std::runtime_error("Failed to acquire a script state");
 
 		// TODO: Refactor
+		// Pooled states only come with spacelib, output functions are bound to this component
+		// Scripts may run concurrently, messages are sent when actions get flushed
 
-		m_instance.PushFunction([this](const Nz::LuaState& state) -> int
+		m_instance->PushFunction([this](const Nz::LuaState& state) -> int
 		{
-			SendMessage(BotMessageType::Info, state.CheckString(1));
+			m_pendingMessages.push_back({ BotMessageType::Info, state.CheckString(1) });
 			return 0;
 		});
 
-		m_instance.PushValue(-1); //< Copy previous function to keep it on stack
-		m_instance.SetGlobal("print");
-		m_instance.SetGlobal("notice");
+		m_instance->PushValue(-1); //< Copy previous function to keep it on stack
+		m_instance->SetGlobal("print");
+		m_instance->SetGlobal("notice");
 
-		m_instance.PushFunction([this](const Nz::LuaState& state) -> int
+		m_instance->PushFunction([this](const Nz::LuaState& state) -> int
 		{
-			SendMessage(BotMessageType::Warning, state.CheckString(1));
+			m_pendingMessages.push_back({ BotMessageType::Warning, state.CheckString(1) });
 			return 0;
 		});
-		m_instance.SetGlobal("warn");
-
-		if (!m_instance.ExecuteFromFile("spacelib.lua"))
-			assert(!"Failed to load spacelib.lua");
+		m_instance->SetGlobal("warn");
 	}
 
 	ScriptComponent::ScriptComponent(const ScriptComponent& component) :
@@ -74,10 +65,10 @@ namespace ewn
 
 	bool ScriptComponent::Execute(Nz::String script, Nz::String* lastError)
 	{
-		if (!m_instance.Execute(script))
+		if (!m_instance->Execute(script))
 		{
 			if (lastError)
-				*lastError = m_instance.GetLastError();
+				*lastError = m_instance->GetLastError();
 
 			return false;
 		}
@@ -86,6 +77,17 @@ namespace ewn
 		return true;
 	}
 
+	void ScriptComponent::FlushActions()
+	{
+		if (m_core)
+			m_core->ExecuteActions();
+
+		for (PendingMessage& pendingMessage : m_pendingMessages)
+			SendMessage(pendingMessage.messageType, std::move(pendingMessage.message));
+
+		m_pendingMessages.clear();
+	}
+
 	bool ScriptComponent::Initialize(ServerApplication* app, const std::vector<std::size_t>& moduleIds)
 	{
 		m_core.emplace(m_entity);
@@ -103,70 +105,40 @@ namespace ewn
 		// Enums
 		constexpr std::size_t ModuleTypeCount = static_cast<std::size_t>(ModuleType::Max) + 1;
 
-		m_instance.PushTable(0, ModuleTypeCount);
+		m_instance->PushTable(0, ModuleTypeCount);
 		for (std::size_t i = 0; i < ModuleTypeCount; ++i)
 		{
 			ModuleType type = static_cast<ModuleType>(i);
 
-			m_instance.PushString(EnumToString(type)); // k
-			m_instance.Push(type);
-			m_instance.SetTable(); // k = v
+			m_instance->PushString(EnumToString(type)); // k
+			m_instance->Push(type);
+			m_instance->SetTable(); // k = v
 		}
-		m_instance.SetGlobal("ModuleType");
+		m_instance->SetGlobal("ModuleType");
 
 		// Spaceship global table
-		m_instance.PushTable();
+		m_instance->PushTable();
 		{
-			m_core->Register(m_instance);
+			m_core->Register(*m_instance);
 		}
-		m_instance.SetGlobal("Spaceship");
+		m_instance->SetGlobal("Spaceship");
 
 		m_core->PushCallback(0, "OnStart");
 
 		return true;
 	}
 
-	bool ScriptComponent::Run(ServerApplication* app, float elapsedTime, Nz::String* lastError)
+	bool ScriptComponent::Run(Nz::String* lastError)
 	{
-		assert(m_core);
-
-		if (!HasValidScript())
+		if (m_pendingCallbacks.empty())
 			return true;
 
-		m_core->Run(elapsedTime);
-
-		std::string callbackName;
-		SpaceshipCore::CallbackArgFunction argFunction;
-
-		Nz::CallOnExit incrementTickCount([&]()
+		Nz::CallOnExit clearCallbacks([&]()
 		{
-			m_tickCounter += elapsedTime;
+			m_pendingCallbacks.clear();
 		});
 
-		if (m_tickCounter >= 0.5f)
-		{
-			callbackName = "OnTick";
-			argFunction = [](Nz::LuaState& state)
-			{
-				state.Push(0.5f);
-				return 1;
-			};
-
-			m_tickCounter -= 0.5f;
-		}
-		else
-		{
-			auto callback = m_core->PopCallback();
-			if (!callback)
-				return true;
-
-			callbackName = std::move(callback->first);
-			argFunction = std::move(callback->second);
-		}
-
-		incrementTickCount.CallAndReset();
-
-		m_instance.PushFunction([](Nz::LuaState& state) -> int
+		m_instance->PushFunction([](Nz::LuaState& state) -> int
 		{
 			state.Traceback(state.ToString(-1));
 			return 1;
@@ -175,34 +147,40 @@ namespace ewn
 		unsigned int popCount = 1;
 		Nz::CallOnExit popLuaStack([&]()
 		{
-			m_instance.Pop(popCount);
+			m_instance->Pop(popCount);
 		});
 
-		unsigned int errorHandler = m_instance.GetStackTop();
+		unsigned int errorHandler = m_instance->GetStackTop();
 
-		if (m_instance.GetGlobal("Spaceship") == Nz::LuaType_Table)
-		{
-			popCount++;
+		bool hasSpaceship = (m_instance->GetGlobal("Spaceship") == Nz::LuaType_Table);
+		popCount++;
+
+		if (!hasSpaceship)
+			return true;
 
-			if (m_instance.GetField(callbackName) == Nz::LuaType_Function)
+		// Every ready callback is fired from the same Lua entry, sharing the error handler and Spaceship lookup
+		for (PendingCallback& callback : m_pendingCallbacks)
+		{
+			if (m_instance->GetField(SpaceshipCore::GetCallbackName(callback.callbackId)) != Nz::LuaType_Function)
 			{
-				m_instance.PushValue(-2); // Spaceship
+				m_instance->Pop();
+				continue;
+			}
 
-				unsigned int argCount = 1;
-				if (argFunction)
-					argCount += argFunction(m_instance);
+			m_instance->PushValue(-2); // Spaceship
 
-				if (!m_instance.CallWithHandler(argCount, 0, errorHandler))
-				{
-					if (lastError)
-						*lastError = m_instance.GetLastError();
+			unsigned int argCount = 1;
+			if (callback.argFunc)
+				argCount += callback.argFunc(*m_instance);
 
-					m_script = Nz::String();
-					return false;
-				}
+			if (!m_instance->CallWithHandler(argCount, 0, errorHandler))
+			{
+				if (lastError)
+					*lastError = m_instance->GetLastError();
+
+				m_script = Nz::String();
+				return false;
 			}
-			else
-				popCount++;
 		}
 
 		return true;
@@ -237,6 +215,41 @@ namespace ewn
 		}
 	}
 
+	bool ScriptComponent::Update(float elapsedTime)
+	{
+		static const SpaceshipCore::CallbackId tickCallbackId = SpaceshipCore::InternCallback("OnTick");
+
+		assert(m_core);
+
+		if (!HasValidScript())
+			return false;
+
+		m_core->Run(elapsedTime);
+
+		m_tickCounter += elapsedTime;
+		if (m_tickCounter >= 0.5f)
+		{
+			m_pendingCallbacks.push_back({ tickCallbackId, [](Nz::LuaState& state)
+			{
+				state.Push(0.5f);
+				return 1;
+			} });
+
+			m_tickCounter -= 0.5f;
+		}
+
+		while (m_pendingCallbacks.size() < MaxCallbackPerUpdate)
+		{
+			auto callback = m_core->PopCallback();
+			if (!callback)
+				break;
+
+			m_pendingCallbacks.push_back({ callback->first, std::move(callback->second) });
+		}
+
+		return !m_pendingCallbacks.empty();
+	}
+
 	void ScriptComponent::OnDetached()
 	{
 		m_core.reset();
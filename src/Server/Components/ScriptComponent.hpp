@@ -12,7 +12,9 @@
 #include <NDK/EntityList.hpp>
 #include <Shared/Enums.hpp>
 #include <Server/SpaceshipCore.hpp>
+#include <memory>
 #include <optional>
+#include <vector>
 
 namespace ewn
 {
@@ -26,22 +28,44 @@ namespace ewn
 
 			bool Execute(Nz::String script, Nz::String* lastError);
 
+			void FlushActions();
+
+			inline SpaceshipCore* GetCore();
+
 			bool Initialize(ServerApplication* app, const std::vector<std::size_t>& moduleIds);
 
 			inline bool HasValidScript() const;
 
-			bool Run(ServerApplication* app, float elapsedTime, Nz::String* lastError = nullptr);
+			bool Run(Nz::String* lastError = nullptr);
 
 			void SendMessage(BotMessageType messageType, Nz::String message);
 
+			bool Update(float elapsedTime);
+
 			static Ndk::ComponentIndex componentIndex;
 
+			static constexpr std::size_t MaxCallbackPerUpdate = 8;
+
 		private:
 			void OnDetached() override;
 
+			struct PendingCallback
+			{
+				SpaceshipCore::CallbackId callbackId;
+				SpaceshipCore::CallbackArgFunction argFunc;
+			};
+
+			struct PendingMessage
+			{
+				BotMessageType messageType;
+				Nz::String message;
+			};
+
 			std::optional<SpaceshipCore> m_core;
+			std::vector<PendingCallback> m_pendingCallbacks;
+			std::vector<PendingMessage> m_pendingMessages;
 			Nz::UInt64 m_lastMessageTime;
-			Nz::LuaInstance m_instance;
+			std::unique_ptr<Nz::LuaInstance> m_instance;
 			Nz::String m_script;
 			float m_tickCounter;
 	};
@@ -6,6 +6,11 @@
 
 namespace ewn
 {
+	inline SpaceshipCore* ScriptComponent::GetCore()
+	{
+		return (m_core) ? &m_core.value() : nullptr;
+	}
+
 	inline bool ewn::ScriptComponent::HasValidScript() const
 	{
 		return !m_script.IsEmpty();
@@ -17,18 +17,13 @@ namespace ewn
 		public:
 			inline SynchronizedComponent(std::size_t prefabId, std::string type, std::string nameTemp, bool movable, Nz::UInt16 networkPriority);
 
-			inline void AccumulatePriority();
-
 			inline const std::string& GetName() const;
 			inline std::size_t GetPrefabId() const;
 			inline Nz::UInt16 GetPriority() const;
-			inline Nz::UInt16 GetPriorityAccumulator() const;
 			inline const std::string& GetType() const;
 
 			inline bool IsMovable() const;
 
-			inline void ResetPriorityAccumulator();
-
 			static Ndk::ComponentIndex componentIndex;
 
 		private:
@@ -36,7 +31,6 @@ namespace ewn
 			std::string m_name;
 			std::string m_type;
 			Nz::UInt16 m_priority;
-			Nz::UInt16 m_priorityAccumulator;
 			bool m_movable;
 	};
 }
@@ -3,7 +3,6 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Components/SynchronizedComponent.hpp>
-#include <limits>
 
 namespace ewn
 {
@@ -12,20 +11,10 @@ namespace ewn
 	m_name(std::move(nameTemp)),
 	m_type(std::move(type)),
 	m_priority(networkPriority),
-	m_priorityAccumulator(networkPriority),
 	m_movable(movable)
 	{
 	}
 
-	inline void SynchronizedComponent::AccumulatePriority()
-	{
-		Nz::UInt16 newPriority = m_priorityAccumulator + m_priority;
-		if (newPriority < m_priorityAccumulator) // Overflow protection
-			m_priorityAccumulator = std::numeric_limits<decltype(m_priorityAccumulator)>::max();
-		else
-			m_priorityAccumulator = newPriority;
-	}
-
 	inline const std::string& SynchronizedComponent::GetName() const
 	{
 		return m_name;
@@ -41,11 +30,6 @@ namespace ewn
 		return m_priority;
 	}
 
-	inline Nz::UInt16 SynchronizedComponent::GetPriorityAccumulator() const
-	{
-		return m_priorityAccumulator;
-	}
-
 	inline const std::string& SynchronizedComponent::GetType() const
 	{
 		return m_type;
@@ -55,9 +39,4 @@ namespace ewn
 	{
 		return m_movable;
 	}
-
-	inline void SynchronizedComponent::ResetPriorityAccumulator()
-	{
-		m_priorityAccumulator = 0;
-	}
 }
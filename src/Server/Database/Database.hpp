@@ -10,7 +10,6 @@
 #include <Nazara/Prerequisites.hpp>
 #include <Server/Database/DatabaseConnection.hpp>
 #include <Server/Database/DatabaseTransaction.hpp>
-#include <Server/Database/DatabaseWorker.hpp>
 #include <concurrentqueue/blockingconcurrentqueue.h>
 #include <memory>
 #include <string>
@@ -18,6 +17,8 @@
 
 namespace ewn
 {
+	class DatabaseWorker;
+
 	class Database
 	{
 		friend DatabaseWorker;
@@ -94,6 +95,7 @@ namespace ewn
 	};
 }
 
+#include <Server/Database/DatabaseWorker.hpp> //< Relies on Database internal types
 #include <Server/Database/Database.inl>
 
 #endif // EREWHON_SERVER_DATABASE_HPP
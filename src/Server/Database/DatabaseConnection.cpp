@@ -15,6 +15,126 @@
 
 namespace ewn
 {
+	namespace
+	{
+		// Converts parameters to their binary representation, which only lives for the duration of the call
+		template<typename F>
+		decltype(auto) WithBinaryParameters(const DatabaseValue* parameters, std::size_t parameterCount, F&& func)
+		{
+			Nz::StackArray<const char*> parameterValues = NazaraStackAllocationNoInit(const char*, parameterCount);
+			Nz::StackArray<int> parameterSize = NazaraStackAllocationNoInit(int, parameterCount);
+			Nz::StackArray<int> parameterFormat = NazaraStackAllocationNoInit(int, parameterCount);
+
+			Nz::Int8 boolTrue = 1;
+			Nz::Int8 boolFalse = 0;
+
+			// Allocate a raw memory array to store temporary representations of types
+			std::size_t memSize = 0;
+			for (std::size_t i = 0; i < parameterCount; ++i)
+			{
+				std::visit([&](auto&& arg)
+				{
+					using T = std::decay_t<decltype(arg)>;
+
+					if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, const char*> ||
+					              std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<Nz::UInt8>>)
+					{
+						// Nothing to do
+					}
+					else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> ||
+					                   std::is_same_v<T, Nz::Int16> || std::is_same_v<T, Nz::Int32> ||
+					                   std::is_same_v<T, Nz::Int64>)
+					{
+						// Primitives types requiring big endian representation
+						memSize += sizeof(T);
+					}
+					else if constexpr (std::is_same_v<T, nlohmann::json>)
+					{
+						//FIXME: Dump JSon only once
+						memSize += arg.dump().size();
+					}
+					else
+						static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+
+				}, parameters[i]);
+			}
+
+			Nz::StackArray<Nz::UInt8> internalRepresentations = NazaraStackAllocationNoInit(Nz::UInt8, memSize);
+			std::size_t internalRepresentationOffset = 0;
+
+			for (std::size_t i = 0; i < parameterCount; ++i)
+			{
+				std::visit([&](auto&& arg)
+				{
+					using T = std::decay_t<decltype(arg)>;
+
+					const void* valuePtr;
+					std::size_t valueSize;
+
+					if constexpr (std::is_same_v<T, bool>)
+					{
+						valuePtr = (arg) ? &boolTrue : &boolFalse;
+						valueSize = 1;
+					}
+					else if constexpr (std::is_same_v<T, char>)
+					{
+						valuePtr = &arg;
+						valueSize = sizeof(char);
+					}
+					else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> ||
+					                   std::is_same_v<T, Nz::Int16> || std::is_same_v<T, Nz::Int32> ||
+					                   std::is_same_v<T, Nz::Int64>)
+					{
+						void* bigEndianPtr = &internalRepresentations[internalRepresentationOffset];
+
+						valuePtr = bigEndianPtr;
+						valueSize = sizeof(T);
+
+						T bigEndianValue = Nz::HostToNet(arg);
+						std::memcpy(bigEndianPtr, &bigEndianValue, sizeof(bigEndianValue));
+						internalRepresentationOffset += valueSize;
+					}
+					else if constexpr (std::is_same_v<T, const char*>)
+					{
+						valuePtr = arg;
+						valueSize = std::strlen(arg);
+					}
+					else if constexpr (std::is_same_v<T, std::string>)
+					{
+						valuePtr = arg.data();
+						valueSize = arg.size();
+					}
+					else if constexpr (std::is_same_v<T, std::vector<Nz::UInt8>>)
+					{
+						valuePtr = arg.data();
+						valueSize = arg.size();
+					}
+					else if constexpr (std::is_same_v<T, nlohmann::json>)
+					{
+						std::string jsonDump = arg.dump();
+						void* internalPtr = &internalRepresentations[internalRepresentationOffset];
+						std::memcpy(internalPtr, jsonDump.data(), jsonDump.size());
+
+						valuePtr = internalPtr;
+						valueSize = jsonDump.size();
+
+						internalRepresentationOffset += jsonDump.size();
+					}
+					else
+						static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+
+					parameterSize[i] = int(valueSize);
+					parameterValues[i] = static_cast<const char*>(valuePtr);
+
+				}, parameters[i]);
+			}
+
+			parameterFormat.fill(1); //< Push everything as binary
+
+			return func(parameterValues.data(), parameterSize.data(), parameterFormat.data());
+		}
+	}
+
 	DatabaseConnection::DatabaseConnection(const std::string& dbHost, const std::string& port, const std::string& dbUser, const std::string& dbPassword, const std::string& dbName)
 	{
 		constexpr std::size_t parameterCount = 14;
@@ -58,6 +178,12 @@ namespace ewn
 			PQfinish(m_connection);
 	}
 
+	DatabaseResult DatabaseConnection::CreateErrorResult() const
+	{
+		// Holds the current connection error message
+		return DatabaseResult(PQmakeEmptyPGresult(m_connection, PGRES_FATAL_ERROR));
+	}
+
 	DatabaseResult DatabaseConnection::Exec(const std::string& query)
 	{
 		return DatabaseResult(PQexec(m_connection, query.data()));
@@ -75,117 +201,28 @@ namespace ewn
 
 	DatabaseResult DatabaseConnection::ExecPreparedStatement(const std::string& statementName, const DatabaseValue* parameters, std::size_t parameterCount)
 	{
-		Nz::StackArray<const char*> parameterValues = NazaraStackAllocationNoInit(const char*, parameterCount);
-		Nz::StackArray<int> parameterSize = NazaraStackAllocationNoInit(int, parameterCount);
-		Nz::StackArray<int> parameterFormat = NazaraStackAllocationNoInit(int, parameterCount);
-
-		Nz::Int8 boolTrue = 1;
-		Nz::Int8 boolFalse = 0;
-
-		// Allocate a raw memory array to store temporary representations of types
-		std::size_t memSize = 0;
-		for (std::size_t i = 0; i < parameterCount; ++i)
+		return WithBinaryParameters(parameters, parameterCount, [&](const char* const* values, const int* sizes, const int* formats)
 		{
-			std::visit([&](auto&& arg)
-			{
-				using T = std::decay_t<decltype(arg)>;
-
-				if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, const char*> ||
-				              std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<Nz::UInt8>>)
-				{
-					// Nothing to do
-				}
-				else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> ||
-				                   std::is_same_v<T, Nz::Int16> || std::is_same_v<T, Nz::Int32> ||
-				                   std::is_same_v<T, Nz::Int64>)
-				{
-					// Primitives types requiring big endian representation
-					memSize += sizeof(T);
-				}
-				else if constexpr (std::is_same_v<T, nlohmann::json>)
-				{
-					//FIXME: Dump JSon only once
-					memSize += arg.dump().size();
-				}
-				else
-					static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
-
-			}, parameters[i]);
-		}
-
-		Nz::StackArray<Nz::UInt8> internalRepresentations = NazaraStackAllocationNoInit(Nz::UInt8, memSize);
-		std::size_t internalRepresentationOffset = 0;
-
-		for (std::size_t i = 0; i < parameterCount; ++i)
-		{
-			std::visit([&](auto&& arg)
-			{
-				using T = std::decay_t<decltype(arg)>;
-
-				const void* valuePtr;
-				std::size_t valueSize;
-
-				if constexpr (std::is_same_v<T, bool>)
-				{
-					valuePtr = (arg) ? &boolTrue : &boolFalse;
-					valueSize = 1;
-				}
-				else if constexpr (std::is_same_v<T, char>)
-				{
-					valuePtr = &arg;
-					valueSize = sizeof(char);
-				}
-				else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> ||
-				                   std::is_same_v<T, Nz::Int16> || std::is_same_v<T, Nz::Int32> ||
-				                   std::is_same_v<T, Nz::Int64>)
-				{
-					void* bigEndianPtr = &internalRepresentations[internalRepresentationOffset];
-
-					valuePtr = bigEndianPtr;
-					valueSize = sizeof(T);
-
-					T bigEndianValue = Nz::HostToNet(arg);
-					std::memcpy(bigEndianPtr, &bigEndianValue, sizeof(bigEndianValue));
-					internalRepresentationOffset += valueSize;
-				}
-				else if constexpr (std::is_same_v<T, const char*>)
-				{
-					valuePtr = arg;
-					valueSize = std::strlen(arg);
-				}
-				else if constexpr (std::is_same_v<T, std::string>)
-				{
-					valuePtr = arg.data();
-					valueSize = arg.size();
-				}
-				else if constexpr (std::is_same_v<T, std::vector<Nz::UInt8>>)
-				{
-					valuePtr = arg.data();
-					valueSize = arg.size();
-				}
-				else if constexpr (std::is_same_v<T, nlohmann::json>)
-				{
-					std::string jsonDump = arg.dump();
-					void* internalPtr = &internalRepresentations[internalRepresentationOffset];
-					std::memcpy(internalPtr, jsonDump.data(), jsonDump.size());
-
-					valuePtr = internalPtr;
-					valueSize = jsonDump.size();
-
-					internalRepresentationOffset += jsonDump.size();
-				}
-				else
-					static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
-
-				parameterSize[i] = int(valueSize);
-				parameterValues[i] = static_cast<const char*>(valuePtr);
-
-			}, parameters[i]);
-		}
+			return DatabaseResult(PQexecPrepared(m_connection, statementName.data(), int(parameterCount), values, sizes, formats, 1));
+		});
+	}
 
-		parameterFormat.fill(1); //< Push everything as binary
+	bool DatabaseConnection::EnterPipelineMode()
+	{
+#ifdef LIBPQ_HAS_PIPELINING
+		return PQenterPipelineMode(m_connection) == 1;
+#else
+		return false;
+#endif
+	}
 
-		return DatabaseResult(PQexecPrepared(m_connection, statementName.data(), int(parameterCount), parameterValues.data(), parameterSize.data(), parameterFormat.data(), 1));
+	bool DatabaseConnection::ExitPipelineMode()
+	{
+#ifdef LIBPQ_HAS_PIPELINING
+		return PQexitPipelineMode(m_connection) == 1;
+#else
+		return false;
+#endif
 	}
 
 	std::string DatabaseConnection::GetLastErrorMessage() const
@@ -224,4 +261,57 @@ namespace ewn
 
 		return DatabaseResult(PQprepare(m_connection, statementName.data(), query.data(), int(parameterIds.size()), parameterIds.data()));
 	}
+
+	bool DatabaseConnection::ReceivePipelineResult(DatabaseResult* result)
+	{
+		assert(result);
+
+#ifdef LIBPQ_HAS_PIPELINING
+		// Statement results are followed by a null result, only the last one is kept
+		PGresult* statementResult = nullptr;
+		while (PGresult* nextResult = PQgetResult(m_connection))
+		{
+			if (statementResult)
+				PQclear(statementResult);
+
+			statementResult = nextResult;
+		}
+
+		*result = (statementResult) ? DatabaseResult(statementResult) : CreateErrorResult();
+
+		// Then comes the sync point sent along with the statement, anything else means we lost track of the pipeline
+		PGresult* syncResult = PQgetResult(m_connection);
+		if (!syncResult)
+			return false;
+
+		bool isSync = (PQresultStatus(syncResult) == PGRES_PIPELINE_SYNC);
+		PQclear(syncResult);
+
+		return isSync;
+#else
+		*result = CreateErrorResult();
+		return false;
+#endif
+	}
+
+	bool DatabaseConnection::SendPipelineSync()
+	{
+#ifdef LIBPQ_HAS_PIPELINING
+		return PQpipelineSync(m_connection) == 1;
+#else
+		return false;
+#endif
+	}
+
+	bool DatabaseConnection::SendPreparedStatement(const std::string& statementName, const std::vector<DatabaseValue>& parameters)
+	{
+#ifdef LIBPQ_HAS_PIPELINING
+		return WithBinaryParameters(parameters.data(), parameters.size(), [&](const char* const* values, const int* sizes, const int* formats)
+		{
+			return PQsendQueryPrepared(m_connection, statementName.data(), int(parameters.size()), values, sizes, formats, 1) == 1;
+		});
+#else
+		return false;
+#endif
+	}
 }
@@ -25,11 +25,17 @@ namespace ewn
 			DatabaseConnection(DatabaseConnection&&) noexcept = default;
 			~DatabaseConnection();
 
+			DatabaseResult CreateErrorResult() const;
+
+			bool EnterPipelineMode();
+
 			DatabaseResult Exec(const std::string& query);
 			DatabaseResult ExecPreparedStatement(const std::string& statementName, std::initializer_list<DatabaseValue> parameters);
 			DatabaseResult ExecPreparedStatement(const std::string& statementName, const std::vector<DatabaseValue>& parameters);
 			DatabaseResult ExecPreparedStatement(const std::string& statementName, const DatabaseValue* parameters, std::size_t parameterCount);
 
+			bool ExitPipelineMode();
+
 			std::string GetLastErrorMessage() const;
 
 			bool IsConnected() const;
@@ -37,6 +43,11 @@ namespace ewn
 
 			DatabaseResult PrepareStatement(const std::string& statementName, const std::string& query, std::initializer_list<DatabaseType> parameterTypes);
 
+			bool ReceivePipelineResult(DatabaseResult* result);
+
+			bool SendPipelineSync();
+			bool SendPreparedStatement(const std::string& statementName, const std::vector<DatabaseValue>& parameters);
+
 			DatabaseConnection& operator=(const DatabaseConnection&) = delete;
 			DatabaseConnection& operator=(DatabaseConnection&&) noexcept = default;
 
@@ -10,6 +10,7 @@
 
 namespace ewn
 {
+	constexpr std::size_t MaxRequestPerBatch = 16;
 	constexpr Nz::UInt64 PingInterval = 10'000; //< 10s
 
 	void DatabaseWorker::ResetIdle()
@@ -23,6 +24,123 @@ namespace ewn
 		m_idleConditionVariable.wait(lock, [this] { return m_idle.load(std::memory_order_acquire); });
 	}
 
+	void DatabaseWorker::HandleQueries(DatabaseConnection& connection, std::vector<Database::QueryRequest*>& queries)
+	{
+		if (queries.empty())
+			return;
+
+		// Pipelining a single query brings nothing
+		if (queries.size() == 1 || !connection.IsConnected() || !connection.EnterPipelineMode())
+		{
+			for (Database::QueryRequest* query : queries)
+			{
+				Database::QueryResult result;
+				result.callback = std::move(query->callback);
+				result.result = connection.ExecPreparedStatement(query->statement, query->parameters);
+
+				m_database.SubmitResult(std::move(result));
+			}
+
+			queries.clear();
+			return;
+		}
+
+		// Send every query before waiting for the first result, the whole batch then costs a single round trip
+		// A sync point per statement keeps them independent, a failing statement won't abort the following ones
+		bool pipelineFailed = false;
+		std::size_t syncedCount = 0;
+		for (Database::QueryRequest* query : queries)
+		{
+			if (!connection.SendPreparedStatement(query->statement, query->parameters) || !connection.SendPipelineSync())
+			{
+				// A statement sent without its sync point cannot be drained, the connection has to be reset
+				pipelineFailed = true;
+				break;
+			}
+
+			syncedCount++;
+		}
+
+		std::size_t queryIndex = 0;
+		for (; queryIndex < syncedCount; ++queryIndex)
+		{
+			Database::QueryResult result;
+			result.callback = std::move(queries[queryIndex]->callback);
+
+			bool synchronized = connection.ReceivePipelineResult(&result.result);
+
+			m_database.SubmitResult(std::move(result));
+
+			if (!synchronized)
+			{
+				pipelineFailed = true;
+				queryIndex++;
+				break;
+			}
+		}
+
+		if (!pipelineFailed && !connection.ExitPipelineMode())
+			pipelineFailed = true;
+
+		if (pipelineFailed)
+		{
+			std::cerr << "Database pipeline failed: " << connection.GetLastErrorMessage() << std::endl;
+
+			// Queries which didn't get their result can't be trusted to have run (or not), fail them
+			for (; queryIndex < queries.size(); ++queryIndex)
+			{
+				Database::QueryResult result;
+				result.callback = std::move(queries[queryIndex]->callback);
+				result.result = connection.CreateErrorResult();
+
+				m_database.SubmitResult(std::move(result));
+			}
+
+			// The connection is left in an unknown pipeline state, start over with a new one
+			connection = m_database.CreateConnection();
+		}
+
+		queries.clear();
+	}
+
+	void DatabaseWorker::HandleTransaction(DatabaseConnection& connection, Database::TransactionRequest& request)
+	{
+		Database::TransactionResult result;
+		result.callback = std::move(request.callback);
+		result.results.reserve(request.transaction.size() + 2); //< + BEGIN/COMMIT results
+
+		DatabaseResult& beginResult = result.results.emplace_back(connection.Exec("START TRANSACTION"));
+		if (beginResult)
+		{
+			bool failure = false;
+			for (std::size_t i = 0; i < request.transaction.size(); ++i)
+			{
+				DatabaseResult& statementResult = result.results.emplace_back(HandleTransactionStatement(connection, request.transaction, request.transaction[i]));
+
+				if (!statementResult)
+				{
+					failure = true;
+					if (connection.IsConnected())
+					{
+						DatabaseResult rollbackResult = connection.Exec("ROLLBACK");
+						if (!rollbackResult)
+							std::cerr << "Rollback failed: " << rollbackResult.GetLastErrorMessage();
+					}
+					break;
+				}
+			}
+
+			if (!failure)
+			{
+				DatabaseResult& commitResult = result.results.emplace_back(connection.Exec("COMMIT"));
+				if (commitResult)
+					result.transactionSucceeded = true;
+			}
+		}
+
+		m_database.SubmitResult(std::move(result));
+	}
+
 	DatabaseResult DatabaseWorker::HandleTransactionStatement(DatabaseConnection& connection, DatabaseTransaction& transaction, const DatabaseTransaction::Statement& transactionStatement)
 	{
 		return std::visit([&](auto&& statement)
@@ -56,7 +174,8 @@ namespace ewn
 
 		moodycamel::ConsumerToken consumerToken(queue);
 
-		Database::Request request;
+		std::vector<Database::Request> requests(MaxRequestPerBatch);
+		std::vector<Database::QueryRequest*> pendingQueries;
 		bool wasConnected = connection.IsConnected();
 
 		Nz::UInt64 lastRequestTime = Nz::GetElapsedMilliseconds();
@@ -86,63 +205,34 @@ namespace ewn
 				wasConnected = true;
 			}
 
-			if (queue.wait_dequeue_timed(consumerToken, request, std::chrono::milliseconds(100)))
+			std::size_t requestCount = queue.wait_dequeue_bulk_timed(consumerToken, requests.begin(), requests.size(), std::chrono::milliseconds(100));
+			if (requestCount > 0)
 			{
 				m_idle.store(false, std::memory_order_release);
 
-				std::visit([&](auto&& request)
+				// Consecutive queries are pipelined together, transactions run on their own as their statements depend on each other
+				for (std::size_t i = 0; i < requestCount; ++i)
 				{
-					using T = std::decay_t<decltype(request)>;
-
-					if constexpr (std::is_same_v<T, Database::QueryRequest>)
+					std::visit([&](auto&& request)
 					{
-						Database::QueryResult result;
-						result.callback = std::move(request.callback);
-						result.result = connection.ExecPreparedStatement(request.statement, request.parameters);
+						using T = std::decay_t<decltype(request)>;
 
-						m_database.SubmitResult(std::move(result));
-					}
-					else if constexpr (std::is_same_v<T, Database::TransactionRequest>)
-					{
-						Database::TransactionResult result;
-						result.callback = std::move(request.callback);
-						result.results.reserve(request.transaction.size() + 2); //< + BEGIN/COMMIT results
-
-						DatabaseResult& beginResult = result.results.emplace_back(connection.Exec("START TRANSACTION"));
-						if (beginResult)
+						if constexpr (std::is_same_v<T, Database::QueryRequest>)
 						{
-							bool failure = false;
-							for (std::size_t i = 0; i < request.transaction.size(); ++i)
-							{
-								DatabaseResult& statementResult = result.results.emplace_back(HandleTransactionStatement(connection, request.transaction, request.transaction[i]));
-
-								if (!statementResult)
-								{
-									failure = true;
-									if (connection.IsConnected())
-									{
-										DatabaseResult rollbackResult = connection.Exec("ROLLBACK");
-										if (!rollbackResult)
-											std::cerr << "Rollback failed: " << rollbackResult.GetLastErrorMessage();
-									}
-									break;
-								}
-							}
-
-							if (!failure)
-							{
-								DatabaseResult& commitResult = result.results.emplace_back(connection.Exec("COMMIT"));
-								if (commitResult)
-									result.transactionSucceeded = true;
-							}
+							pendingQueries.push_back(&request);
 						}
+						else if constexpr (std::is_same_v<T, Database::TransactionRequest>)
+						{
+							HandleQueries(connection, pendingQueries);
+							HandleTransaction(connection, request);
+						}
+						else
+							static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
 
-						m_database.SubmitResult(std::move(result));
-					}
-					else
-						static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+					}, requests[i]);
+				}
 
-				}, request);
+				HandleQueries(connection, pendingQueries);
 
 				lastRequestTime = Nz::GetElapsedMilliseconds();
 			}
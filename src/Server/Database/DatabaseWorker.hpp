@@ -9,17 +9,17 @@
 
 #include <Nazara/Prerequisites.hpp>
 #include <Nazara/Core/Thread.hpp>
+#include <Server/Database/Database.hpp>
 #include <Server/Database/DatabaseConnection.hpp>
 #include <Server/Database/DatabaseTransaction.hpp>
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace ewn
 {
-	class Database;
-
 	class DatabaseWorker final
 	{
 		public:
@@ -36,6 +36,8 @@ namespace ewn
 			DatabaseWorker& operator=(DatabaseWorker&&) = delete;
 
 		private:
+			void HandleQueries(DatabaseConnection& connection, std::vector<Database::QueryRequest*>& queries);
+			void HandleTransaction(DatabaseConnection& connection, Database::TransactionRequest& request);
 			DatabaseResult HandleTransactionStatement(DatabaseConnection& connection, DatabaseTransaction& transaction, const DatabaseTransaction::Statement& transactionStatement);
 			void WorkerThread();
 
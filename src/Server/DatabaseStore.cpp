@@ -16,7 +16,7 @@ namespace ewn
 		database.ExecuteQuery(m_query, {}, [this, app, cb = std::move(callback)](DatabaseResult& result)
 		{
 			if (result)
-				cb(FillStore(app, result));
+				cb(FillStoreFromDatabase(app, result));
 			else
 			{
 				std::cerr << "An error occurred on prepared statement " << m_query << ": " << result.GetLastErrorMessage() << std::endl;
@@ -7,6 +7,7 @@
 #ifndef EREWHON_SERVER_DATABASESTORE_HPP
 #define EREWHON_SERVER_DATABASESTORE_HPP
 
+#include <Nazara/Core/Signal.hpp>
 #include <functional>
 #include <string>
 
@@ -31,6 +32,8 @@ namespace ewn
 
 			static constexpr std::size_t InvalidEntryId = std::numeric_limits<std::size_t>::max();
 
+			NazaraSignal(OnStoreLoaded, DatabaseStore* /*store*/);
+
 		protected:
 			inline DatabaseStore(std::string query);
 
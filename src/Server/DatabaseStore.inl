@@ -21,6 +21,9 @@ namespace ewn
 	inline bool DatabaseStore::FillStoreFromDatabase(ServerApplication* app, DatabaseResult& result)
 	{
 		m_isLoaded = FillStore(app, result);
+		if (m_isLoaded)
+			OnStoreLoaded(this);
+
 		return IsLoaded();
 	}
 }
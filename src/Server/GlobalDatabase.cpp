@@ -18,11 +18,9 @@ namespace ewn
 			PrepareStatement(conn, "DeleteSpaceship", "DELETE FROM spaceships WHERE owner_id = $1 AND name = LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
 			PrepareStatement(conn, "FindAccountByLogin", "SELECT id, password, password_salt FROM accounts WHERE login=LOWER($1)", { DatabaseType::Text });
 			PrepareStatement(conn, "FindAccountByToken", "SELECT account_id FROM account_tokens WHERE token=$1", { DatabaseType::Text });
-			PrepareStatement(conn, "FindFleetByOwnerIdAndName", "SELECT id FROM fleets WHERE owner_id = $1 AND name=LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
-			PrepareStatement(conn, "FindFleetSpaceshipsByFleetId", "SELECT spaceship_id, spaceship_count, name, script, spaceship_hull_id FROM fleet_spaceships INNER JOIN spaceships ON id = spaceship_id WHERE fleet_id = $1", { DatabaseType::Int32 });
-			PrepareStatement(conn, "FindSpaceshipByOwnerIdAndName", "SELECT id, script, spaceship_hull_id FROM spaceships WHERE owner_id = $1 AND name=LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
-			PrepareStatement(conn, "FindSpaceshipByIdAndOwnerId", "SELECT name, script, spaceship_hull_id FROM spaceships WHERE id = $1 AND owner_id=$2", { DatabaseType::Int32, DatabaseType::Int32 });
-			PrepareStatement(conn, "FindSpaceshipModulesBySpaceshipId", "SELECT module_id FROM spaceship_modules WHERE spaceship_id = $1", { DatabaseType::Int32 });
+			PrepareStatement(conn, "FindFleetSpaceshipsByOwnerIdAndName", "SELECT fleet_spaceships.spaceship_id, fleet_spaceships.spaceship_count, spaceships.script, spaceships.spaceship_hull_id, COALESCE((SELECT json_agg(module_id) FROM spaceship_modules WHERE spaceship_modules.spaceship_id = spaceships.id), '[]'::json) FROM fleets LEFT JOIN fleet_spaceships ON fleet_spaceships.fleet_id = fleets.id LEFT JOIN spaceships ON spaceships.id = fleet_spaceships.spaceship_id WHERE fleets.owner_id = $1 AND fleets.name = LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
+			PrepareStatement(conn, "FindSpaceshipWithModulesByOwnerIdAndName", "SELECT id, script, spaceship_hull_id, COALESCE((SELECT json_agg(module_id) FROM spaceship_modules WHERE spaceship_modules.spaceship_id = spaceships.id), '[]'::json) FROM spaceships WHERE owner_id = $1 AND name=LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
+			PrepareStatement(conn, "FindSpaceshipWithModulesByIdAndOwnerId", "SELECT id, script, spaceship_hull_id, COALESCE((SELECT json_agg(module_id) FROM spaceship_modules WHERE spaceship_modules.spaceship_id = spaceships.id), '[]'::json), name FROM spaceships WHERE id = $1 AND owner_id = $2", { DatabaseType::Int32, DatabaseType::Int32 });
 			PrepareStatement(conn, "FindSpaceshipIdByOwnerIdAndName", "SELECT id FROM spaceships WHERE owner_id = $1 AND name=LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
 			PrepareStatement(conn, "FindSpaceshipsByOwnerId", "SELECT id, name FROM spaceships WHERE owner_id = $1", { DatabaseType::Int32 });
 			PrepareStatement(conn, "LoadAccount", "SELECT login, display_name, permission_level FROM accounts WHERE id=$1;", { DatabaseType::Int32 });
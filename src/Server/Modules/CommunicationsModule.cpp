@@ -4,12 +4,12 @@
 
 #include <Server/Modules/CommunicationsModule.hpp>
 #include <Nazara/Core/MemoryHelper.hpp>
-#include <Nazara/Physics3D/PhysWorld3D.hpp>
 #include <NDK/LuaAPI.hpp>
 #include <NDK/World.hpp>
-#include <NDK/Systems/PhysicsSystem3D.hpp>
 #include <Server/Scripting/LuaMathTypes.hpp>
 #include <Server/Components/CommunicationComponent.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
+#include <algorithm>
 #include <cmath>
 
 namespace ewn
@@ -29,6 +29,11 @@ namespace ewn
 
 	void CommunicationsModule::BroadcastCone(const Nz::Vector3f& direction, float distance, const std::string& message)
 	{
+		if (!std::isfinite(distance) || distance <= 0.f)
+			return;
+
+		distance = std::min(distance, MaxBroadcastDistance);
+
 		const Ndk::EntityHandle& spaceship = GetSpaceship();
 		auto& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
 
@@ -37,53 +42,35 @@ namespace ewn
 		Nz::Vector3f position = spaceshipNode.GetPosition();
 		Nz::Boxf detectionBox = Nz::Boxf(spaceshipNode.GetPosition() + spaceshipNode.GetLeft() * coneBaseRadius + spaceshipNode.GetUp() * coneBaseRadius, spaceshipNode.GetPosition() + spaceshipNode.GetForward() * distance + spaceshipNode.GetRight() * coneBaseRadius + spaceshipNode.GetDown() * coneBaseRadius);
 
-		Ndk::World* world = spaceship->GetWorld();
-		Nz::PhysWorld3D& physWorld = world->GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
-		physWorld.ForEachBodyInAABB(detectionBox, [&](Nz::RigidBody3D& body)
+		// Receivers are queried when actions are applied, so every broadcast can reuse the same buffer
+		//TODO: Check for cone
+		PushAction([this, detectionBox, message]()
 		{
-			Nz::Vector3f bodyPosition = body.GetPosition();
-			//TODO: Check for cone
-			if (/*cone check*/ true)
-			{
-				Ndk::EntityId bodyId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(body.GetUserdata()));
-				if (bodyId != spaceship->GetId())
-				{
-					const Ndk::EntityHandle& bodyEntity = world->GetEntity(bodyId);
-					if (bodyEntity->HasComponent<CommunicationComponent>())
-						bodyEntity->GetComponent<CommunicationComponent>().SendMessage(spaceship, message);
-				}
-			}
+			m_receivers.clear();
+			GetSpaceship()->GetWorld()->GetSystem<SpatialSystem>().QueryBox(detectionBox, m_receivers);
 
-			return true;
+			DeliverMessage(m_receivers, message);
 		});
 	}
 
 	void CommunicationsModule::BroadcastSphere(float distance, const std::string& message)
 	{
+		if (!std::isfinite(distance) || distance <= 0.f)
+			return;
+
+		distance = std::min(distance, MaxBroadcastDistance);
+
 		const Ndk::EntityHandle& spaceship = GetSpaceship();
 		auto& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
 
 		Nz::Vector3f position = spaceshipNode.GetPosition();
-		Nz::Boxf detectionBox = Nz::Boxf(position - Nz::Vector3f(distance), position + Nz::Vector3f(distance));
 
-		Ndk::World* world = spaceship->GetWorld();
-		Nz::PhysWorld3D& physWorld = world->GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
-		float maxSquaredRadius = distance * distance;
-		physWorld.ForEachBodyInAABB(detectionBox, [&](Nz::RigidBody3D& body)
+		PushAction([this, position, distance, message]()
 		{
-			Nz::Vector3f bodyPosition = body.GetPosition();
-			if (bodyPosition.SquaredDistance(position) < maxSquaredRadius)
-			{
-				Ndk::EntityId bodyId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(body.GetUserdata()));
-				if (bodyId != spaceship->GetId())
-				{
-					const Ndk::EntityHandle& bodyEntity = world->GetEntity(bodyId);
-					if (bodyEntity->HasComponent<CommunicationComponent>())
-						bodyEntity->GetComponent<CommunicationComponent>().SendMessage(spaceship, message);
-				}
-			}
+			m_receivers.clear();
+			GetSpaceship()->GetWorld()->GetSystem<SpatialSystem>().QuerySphere(position, distance, m_receivers);
 
-			return true;
+			DeliverMessage(m_receivers, message);
 		});
 	}
 
@@ -116,7 +103,9 @@ namespace ewn
 				const Ndk::EntityHandle& spaceship = GetSpaceship();
 				auto& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
 
-				PushCallback("OnCommunicationReceivedMessages", [messages = m_pendingMessages, position = spaceshipNode.GetPosition()](Nz::LuaState& state)
+				static const SpaceshipCore::CallbackId receivedMessagesCallbackId = SpaceshipCore::InternCallback("OnCommunicationReceivedMessages");
+
+				PushCallback(receivedMessagesCallbackId, [messages = m_pendingMessages, position = spaceshipNode.GetPosition()](Nz::LuaState& state)
 				{
 					state.PushTable(messages.size());
 
@@ -155,5 +144,21 @@ namespace ewn
 		newMessage.position = emitterPos;
 	}
 
+	void CommunicationsModule::DeliverMessage(const std::vector<SpatialSystem::Entry>& receivers, const std::string& message)
+	{
+		const Ndk::EntityHandle& spaceship = GetSpaceship();
+		Ndk::World* world = spaceship->GetWorld();
+
+		for (const SpatialSystem::Entry& receiver : receivers)
+		{
+			if (receiver.entityId == spaceship->GetId())
+				continue;
+
+			const Ndk::EntityHandle& receiverEntity = world->GetEntity(receiver.entityId);
+			if (receiverEntity->HasComponent<CommunicationComponent>())
+				receiverEntity->GetComponent<CommunicationComponent>().SendMessage(spaceship, message);
+		}
+	}
+
 	std::optional<Nz::LuaClass<CommunicationsModuleHandle>> CommunicationsModule::s_binding;
 }
@@ -11,6 +11,7 @@
 #include <Nazara/Math/Vector3.hpp>
 #include <Server/SpaceshipModule.hpp>
 #include <Server/Components/CommunicationComponent.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
 #include <optional>
 #include <vector>
 
@@ -37,8 +38,10 @@ namespace ewn
 			void BroadcastCone(const Nz::Vector3f& direction, float distance, const std::string& message);
 			void BroadcastSphere(float distance, const std::string& message);
 
+			static constexpr float MaxBroadcastDistance = 2000.f;
 
 		private:
+			void DeliverMessage(const std::vector<SpatialSystem::Entry>& receivers, const std::string& message);
 			void OnReceivedMessage(CommunicationComponent* /*communication*/, const Ndk::EntityHandle& emitter, const std::string& message);
 
 			NazaraSlot(CommunicationComponent, OnReceivedMessage, m_onReceivedMessageSlot);
@@ -51,6 +54,7 @@ namespace ewn
 
 			float m_callbackCounter;
 			std::vector<PendingMessage> m_pendingMessages;
+			std::vector<SpatialSystem::Entry> m_receivers;
 
 			static std::optional<Nz::LuaClass<CommunicationsModuleHandle>> s_binding;
 	};
@@ -15,8 +15,13 @@ namespace ewn
 		impulse.y = Nz::Clamp(impulse.y, -1.f, 1.f);
 		impulse.z = Nz::Clamp(impulse.z, -1.f, 1.f);
 
-		NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
-		spaceshipNavigation.AddImpulse(impulse, ServerApplication::GetAppTime() + Nz::UInt64(duration * 1'000));
+		Nz::UInt64 expirationTime = ServerApplication::GetAppTime() + Nz::UInt64(duration * 1'000);
+
+		PushAction([this, impulse, expirationTime]()
+		{
+			NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
+			spaceshipNavigation.AddImpulse(impulse, expirationTime);
+		});
 	}
 
 	void EngineModule::PushInstance(Nz::LuaState& lua)
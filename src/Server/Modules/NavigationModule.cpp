@@ -94,58 +94,77 @@ namespace ewn
 		if (!radarModule)
 			return;
 
-		const Ndk::EntityHandle& spaceship = GetSpaceship();
-		NavigationComponent& spaceshipNavigation = spaceship->GetComponent<NavigationComponent>();
-		if (const Ndk::EntityHandle& target = radarModule->FindEntityBySignature(targetSignature))
-			spaceshipNavigation.SetTarget(target);
-		else
-			spaceshipNavigation.ClearTarget();
+		PushAction([this, radarModule, targetSignature]()
+		{
+			const Ndk::EntityHandle& spaceship = GetSpaceship();
+			NavigationComponent& spaceshipNavigation = spaceship->GetComponent<NavigationComponent>();
+			if (const Ndk::EntityHandle& target = radarModule->FindEntityBySignature(targetSignature))
+				spaceshipNavigation.SetTarget(target);
+			else
+				spaceshipNavigation.ClearTarget();
+		});
 	}
 
 	void NavigationModule::FollowTarget(Nz::Int64 targetSignature, float triggerDistance)
 	{
+		static const SpaceshipCore::CallbackId destinationReachedCallbackId = SpaceshipCore::InternCallback("OnNavigationDestinationReached");
+
 		RadarModule* radarModule = GetCore()->GetModule<RadarModule>(ModuleType::Radar);
 		if (!radarModule)
 			return;
 
-		const Ndk::EntityHandle& spaceship = GetSpaceship();
-		NavigationComponent& spaceshipNavigation = spaceship->GetComponent<NavigationComponent>();
-		if (const Ndk::EntityHandle& target = radarModule->FindEntityBySignature(targetSignature))
+		PushAction([this, radarModule, targetSignature, triggerDistance]()
 		{
-			spaceshipNavigation.SetTarget(target, triggerDistance, [moduleHandle = CreateHandle()]()
+			const Ndk::EntityHandle& spaceship = GetSpaceship();
+			NavigationComponent& spaceshipNavigation = spaceship->GetComponent<NavigationComponent>();
+			if (const Ndk::EntityHandle& target = radarModule->FindEntityBySignature(targetSignature))
 			{
-				if (!moduleHandle)
-					return;
-
-				moduleHandle->PushCallback("OnNavigationDestinationReached");
-			});
-		}
-		else
-			spaceshipNavigation.ClearTarget();
+				spaceshipNavigation.SetTarget(target, triggerDistance, [moduleHandle = CreateHandle()]()
+				{
+					if (!moduleHandle)
+						return;
+
+					moduleHandle->PushCallback(destinationReachedCallbackId);
+				});
+			}
+			else
+				spaceshipNavigation.ClearTarget();
+		});
 	}
 
 	void NavigationModule::MoveToPosition(const Nz::Vector3f& targetPos)
 	{
-		NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
-		spaceshipNavigation.SetTarget(targetPos);
+		PushAction([this, targetPos]()
+		{
+			NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
+			spaceshipNavigation.SetTarget(targetPos);
+		});
 	}
 
 	void NavigationModule::MoveToPosition(const Nz::Vector3f& targetPos, float triggerDistance)
 	{
-		NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
-		spaceshipNavigation.SetTarget(targetPos, triggerDistance, [moduleHandle = CreateHandle()]()
+		static const SpaceshipCore::CallbackId destinationReachedCallbackId = SpaceshipCore::InternCallback("OnNavigationDestinationReached");
+
+		PushAction([this, targetPos, triggerDistance]()
 		{
-			if (!moduleHandle)
-				return;
+			NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
+			spaceshipNavigation.SetTarget(targetPos, triggerDistance, [moduleHandle = CreateHandle()]()
+			{
+				if (!moduleHandle)
+					return;
 
-			moduleHandle->PushCallback("OnNavigationDestinationReached");
+				moduleHandle->PushCallback(destinationReachedCallbackId);
+			});
 		});
 	}
 
 	void NavigationModule::Stop()
 	{
-		NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
-		spaceshipNavigation.ClearTarget();
+		PushAction([this]()
+		{
+			NavigationComponent& spaceshipNavigation = GetSpaceship()->GetComponent<NavigationComponent>();
+			spaceshipNavigation.ClearTarget();
+		});
 	}
 
 	std::optional<Nz::LuaClass<NavigationModuleHandle>> NavigationModule::s_binding;
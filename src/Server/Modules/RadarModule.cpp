@@ -4,16 +4,14 @@
 
 #include <Server/Modules/RadarModule.hpp>
 #include <Nazara/Core/Clock.hpp>
-#include <Nazara/Math/BoundingVolume.hpp>
-#include <Nazara/Physics3D/PhysWorld3D.hpp>
 #include <NDK/LuaAPI.hpp>
 #include <NDK/World.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Components/PhysicsComponent3D.hpp>
-#include <NDK/Systems/PhysicsSystem3D.hpp>
 #include <Server/Components/SignatureComponent.hpp>
 #include <Server/Components/SynchronizedComponent.hpp>
 #include <Server/Scripting/LuaTypes.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
 #include <iostream>
 
 namespace ewn
@@ -80,7 +78,7 @@ namespace ewn
 		if (m_isPassiveScanEnabled)
 		{
 			Nz::UInt64 now = ServerApplication::GetAppTime();
-			if (now - m_lastPassiveScanTime > 500)
+			if (now - m_lastPassiveScanTime >= PassiveScanInterval)
 			{
 				PerformScan();
 				m_lastPassiveScanTime = now;
@@ -97,16 +95,16 @@ namespace ewn
 		{
 			auto& targetNode = target->GetComponent<Ndk::NodeComponent>();
 			if (targetNode.GetPosition().SquaredDistance(radarCenter) > maxDetectionRadiusSq)
-			{
 				m_entitiesInRadius.Remove(target);
+		}
 
-				if (target->HasComponent<SignatureComponent>())
-				{
-					const SignatureComponent& component = target->GetComponent<SignatureComponent>();
-
-					m_signatureToEntity.erase(component.GetSignature());
-				}
-			}
+		// Forget signatures of targets which were destroyed or left the radar range
+		for (auto it = m_signatureToEntity.begin(); it != m_signatureToEntity.end();)
+		{
+			if (!it->second || !m_entitiesInRadius.Has(it->second))
+				it = m_signatureToEntity.erase(it);
+			else
+				++it;
 		}
 	}
 
@@ -116,56 +114,44 @@ namespace ewn
 		auto& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
 
 		Nz::Vector3f position = spaceshipNode.GetPosition();
-		Nz::Boxf detectionBox = Nz::Boxf(position - Nz::Vector3f(m_detectionRadius), position + Nz::Vector3f(m_detectionRadius));
 
 		Ndk::World* world = spaceship->GetWorld();
-		Nz::PhysWorld3D& physWorld = world->GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
-		float maxSquaredRadius = m_detectionRadius * m_detectionRadius;
-		physWorld.ForEachBodyInAABB(detectionBox, [&](Nz::RigidBody3D& body)
+
+		static const SpaceshipCore::CallbackId newObjectCallbackId = SpaceshipCore::InternCallback("OnRadarNewObjectInRange");
+
+		m_scanResults.clear();
+		world->GetSystem<SpatialSystem>().QuerySphere(position, m_detectionRadius, m_scanResults);
+
+		for (const SpatialSystem::Entry& entry : m_scanResults)
 		{
-			Nz::Vector3f bodyPosition = body.GetPosition();
-			if (bodyPosition.SquaredDistance(position) < maxSquaredRadius)
-			{
-				Ndk::EntityId bodyId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(body.GetUserdata()));
-				if (!m_entitiesInRadius.Has(bodyId) && bodyId != spaceship->GetId())
-				{
-					const Ndk::EntityHandle& bodyEntity = world->GetEntity(bodyId);
-
-					m_entitiesInRadius.Insert(bodyEntity);
-
-					Nz::Int64 signature = bodyEntity->GetId(); //< Meh
-					double radius = -1.f;
-					double emSignature = 0.0;
-					if (bodyEntity->HasComponent<SignatureComponent>())
-					{
-						const SignatureComponent& component = bodyEntity->GetComponent<SignatureComponent>();
-						emSignature = component.GetEmSignature();
-						signature = component.GetSignature();
-						radius = component.GetSize();
-
-						m_signatureToEntity.insert_or_assign(signature, bodyEntity);
-					}
-
-					float distance;
-					Nz::Vector3f direction = bodyPosition - position;
-					direction.Normalize(&distance);
-
-					PushCallback("OnRadarNewObjectInRange", [signature, emSignature, radius, direction, distance](Nz::LuaState& state)
-					{
-						state.Push(signature);
-						state.Push(emSignature);
-						state.Push(radius);
-						state.Push(LuaVec3(direction));
-						state.Push(distance);
-
-						return 5;
-					},
-					false);
-				}
-			}
+			if (entry.entityId == spaceship->GetId() || m_entitiesInRadius.Has(entry.entityId))
+				continue;
+
+			const Ndk::EntityHandle& bodyEntity = world->GetEntity(entry.entityId);
+			m_entitiesInRadius.Insert(bodyEntity);
+
+			Nz::Int64 signature = entry.signature;
+			double radius = entry.size;
+			double emSignature = entry.emSignature;
+			if (entry.hasSignature)
+				m_signatureToEntity.insert_or_assign(signature, bodyEntity);
+
+			float distance;
+			Nz::Vector3f direction = entry.position - position;
+			direction.Normalize(&distance);
 
-			return true;
-		});
+			PushCallback(newObjectCallbackId, [signature, emSignature, radius, direction, distance](Nz::LuaState& state)
+			{
+				state.Push(signature);
+				state.Push(emSignature);
+				state.Push(radius);
+				state.Push(LuaVec3(direction));
+				state.Push(distance);
+
+				return 5;
+			},
+			false);
+		}
 	}
 
 	std::optional<RadarModule::TargetInfo> RadarModule::GetTargetInfo(Nz::Int64 signature)
@@ -174,12 +160,9 @@ namespace ewn
 		if (!target)
 			return {};
 
+		// Stale signatures are cleaned up by Run(), scripts run in parallel and must not destroy entity handles
 		if (!m_entitiesInRadius.Has(target))
-		{
-			//TODO: Log?
-			m_signatureToEntity.erase(signature);
 			return {};
-		}
 
 		const Ndk::EntityHandle& spaceship = GetSpaceship();
 
@@ -11,6 +11,7 @@
 #include <NDK/EntityList.hpp>
 #include <Server/SpaceshipModule.hpp>
 #include <Server/Scripting/LuaMathTypes.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
 #include <optional>
 #include <unordered_map>
 
@@ -30,6 +31,7 @@ namespace ewn
 			~RadarModule() = default;
 
 			inline const Ndk::EntityHandle& FindEntityBySignature(Nz::Int64 signature) const;
+			inline float GetDetectionRadius() const;
 			void PushInstance(Nz::LuaState& lua) override;
 			void RegisterModule(Nz::LuaClass<SpaceshipModule>& parentBinding, Nz::LuaState& lua) override;
 			void Run(float elapsedTime) override;
@@ -43,6 +45,7 @@ namespace ewn
 
 			std::vector<RangeInfo> Scan();
 
+			static constexpr Nz::UInt64 PassiveScanInterval = 500; //< Milliseconds
 
 			struct RangeInfo
 			{
@@ -72,6 +75,7 @@ namespace ewn
 
 			std::size_t m_maxLockableTargets;
 			std::unordered_map<Nz::Int64 /*signature*/, Ndk::EntityHandle /*entity*/> m_signatureToEntity;
+			std::vector<SpatialSystem::Entry> m_scanResults;
 			Ndk::EntityList m_entitiesInRadius;
 			Ndk::EntityId m_lockedEntity;
 			Nz::UInt64 m_lastPassiveScanTime;
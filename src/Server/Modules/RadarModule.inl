@@ -3,12 +3,14 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Modules/RadarModule.hpp>
+#include <Shared/BaseApplication.hpp>
 
 namespace ewn
 {
 	inline RadarModule::RadarModule(SpaceshipCore* core, const Ndk::EntityHandle & spaceship, float detectionRadius, std::size_t maxLockableTarget) :
 	SpaceshipModule(ModuleType::Radar, core, spaceship, true),
 	m_maxLockableTargets(maxLockableTarget),
+	m_lastPassiveScanTime(BaseApplication::GetAppTime() - PassiveScanInterval), //< First passive scan happens on first run
 	m_detectionRadius(detectionRadius),
 	m_isPassiveScanEnabled(true)
 	{
@@ -23,6 +25,11 @@ namespace ewn
 		return signatureIt->second;
 	}
 
+	inline float RadarModule::GetDetectionRadius() const
+	{
+		return m_detectionRadius;
+	}
+
 	inline void RadarModule::EnablePassiveScan(bool enable)
 	{
 		m_isPassiveScanEnabled = enable;
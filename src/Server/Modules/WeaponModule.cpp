@@ -36,7 +36,7 @@ namespace ewn
 
 		m_lastShootTime = currentTime;
 
-		DoShoot();
+		PushAction([this]() { DoShoot(); });
 	}
 
 	std::optional<Nz::LuaClass<WeaponModuleHandle>> WeaponModule::s_binding;
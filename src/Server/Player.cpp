@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Player.hpp>
+#include <NDK/Components/CollisionComponent3D.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Components/PhysicsComponent3D.hpp>
 #include <Server/Arena.hpp>
@@ -34,6 +35,19 @@ namespace ewn
 			m_arena->HandlePlayerLeave(this);
 	}
 
+	void Player::AcknowledgeArenaState(Nz::UInt16 stateId)
+	{
+		// Only states sent to us since we joined this arena can be used as baselines
+		if (!m_arenaStateHistory.HasState(stateId))
+			return;
+
+		// Acks are sent unreliably and may arrive out of order, only keep the most recent one (state ids wrap around)
+		if (m_lastAcknowledgedStateId && static_cast<Nz::Int16>(stateId - *m_lastAcknowledgedStateId) <= 0)
+			return;
+
+		m_lastAcknowledgedStateId = stateId;
+	}
+
 	void Player::Authenticate(Nz::Int32 dbId, std::function<void(Player*, bool succeeded)> authenticationCallback)
 	{
 		m_databaseId = dbId;
@@ -123,6 +137,8 @@ namespace ewn
 			m_arena->HandlePlayerLeave(this);
 
 		m_arena = arena;
+		m_arenaStateHistory.Clear(); //< Baselines are per-arena
+		m_lastAcknowledgedStateId.reset();
 		if (m_arena)
 			m_arena->HandlePlayerJoin(this);
 	}
@@ -164,6 +180,17 @@ namespace ewn
 			// Control packet
 			Packets::ControlEntity controlPacket;
 			controlPacket.id = (m_controlledEntity) ? m_controlledEntity->GetId() : 0;
+			controlPacket.inertia = Nz::Vector3f::Zero();
+
+			// Client needs the same inertia as the physics engine to predict rotations (see Nz::RigidBody3D::SetMass)
+			if (m_controlledEntity && m_controlledEntity->HasComponent<Ndk::CollisionComponent3D>() && m_controlledEntity->HasComponent<Ndk::PhysicsComponent3D>())
+			{
+				Nz::Vector3f center;
+				m_controlledEntity->GetComponent<Ndk::CollisionComponent3D>().GetGeom()->ComputeInertialMatrix(&controlPacket.inertia, &center);
+
+				controlPacket.inertia *= m_controlledEntity->GetComponent<Ndk::PhysicsComponent3D>().GetMass();
+			}
+
 			SendPacket(controlPacket);
 		}
 	}
@@ -171,6 +198,7 @@ namespace ewn
 	void Player::UpdateInput(Nz::UInt64 lastInputTime, Nz::Vector3f movement, Nz::Vector3f rotation)
 	{
 		//TODO: Check input time consistency and possibly kick player
+		// Clients repeat their last inputs in every movement packet, skip those we already got
 		if (lastInputTime <= m_lastInputTime)
 			return;
 
@@ -11,7 +11,9 @@
 #include <Nazara/Core/ObjectHandle.hpp>
 #include <NDK/EntityOwner.hpp>
 #include <Shared/NetworkReactor.hpp>
+#include <Shared/Protocol/ArenaStateHistory.hpp>
 #include <Server/ServerCommandStore.hpp>
+#include <optional>
 
 namespace ewn
 {
@@ -29,6 +31,8 @@ namespace ewn
 			Player(ServerApplication* app, std::size_t peerId, std::size_t sessionId, NetworkReactor& reactor, const ServerCommandStore& commandStore);
 			~Player();
 
+			void AcknowledgeArenaState(Nz::UInt16 stateId);
+
 			void Authenticate(Nz::Int32 dbId, std::function<void (Player*, bool succeeded)> authenticationCallback);
 
 			inline void ClearBots();
@@ -37,8 +41,11 @@ namespace ewn
 			inline void Disconnect(Nz::UInt32 data = 0);
 
 			inline Arena* GetArena() const;
+			inline ArenaStateHistory& GetArenaStateHistory();
+			inline const std::vector<Ndk::EntityOwner>& GetBots() const;
 			inline const Ndk::EntityHandle& GetControlledEntity() const;
 			inline Nz::Int32 GetDatabaseId() const;
+			inline const std::optional<Nz::UInt16>& GetLastAcknowledgedStateId() const;
 			Nz::UInt64 GetLastInputProcessedTime() const;
 			inline const std::string& GetLogin() const;
 			inline Nz::UInt16 GetPermissionLevel() const;
@@ -55,6 +62,7 @@ namespace ewn
 			void PrintMessage(std::string chatMessage);
 
 			template<typename T> void SendPacket(const T& packet);
+			template<typename T> void SendSharedPacket(const NetworkReactor::SharedPacket& packet);
 
 			void Shoot();
 
@@ -79,6 +87,8 @@ namespace ewn
 			Nz::UInt16 m_permissionLevel;
 			Nz::UInt64 m_lastInputTime;
 			Nz::UInt64 m_lastShootTime;
+			std::optional<Nz::UInt16> m_lastAcknowledgedStateId;
+			ArenaStateHistory m_arenaStateHistory;
 			bool m_authenticated;
 	};
 }
@@ -29,6 +29,16 @@ namespace ewn
 		return m_arena;
 	}
 
+	inline ArenaStateHistory& Player::GetArenaStateHistory()
+	{
+		return m_arenaStateHistory;
+	}
+
+	inline const std::vector<Ndk::EntityOwner>& Player::GetBots() const
+	{
+		return m_botEntities;
+	}
+
 	const Ndk::EntityHandle& Player::GetControlledEntity() const
 	{
 		return m_controlledEntity;
@@ -39,6 +49,11 @@ namespace ewn
 		return m_databaseId;
 	}
 
+	inline const std::optional<Nz::UInt16>& Player::GetLastAcknowledgedStateId() const
+	{
+		return m_lastAcknowledgedStateId;
+	}
+
 	inline const std::string& Player::GetLogin() const
 	{
 		return m_login;
@@ -79,4 +94,12 @@ namespace ewn
 
 		m_networkReactor.SendData(m_peerId, command.channelId, command.flags, std::move(data));
 	}
+
+	template<typename T>
+	void Player::SendSharedPacket(const NetworkReactor::SharedPacket& packet)
+	{
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+
+		m_networkReactor.SendData(m_peerId, command.channelId, command.flags, packet);
+	}
 }
@@ -0,0 +1,108 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Scripting/ScriptStatePool.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace ewn
+{
+	std::unique_ptr<Nz::LuaInstance> ScriptStatePool::Acquire()
+	{
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			if (!s_states.empty())
+			{
+				std::unique_ptr<Nz::LuaInstance> state = std::move(s_states.back());
+				s_states.pop_back();
+
+				return state;
+			}
+		}
+
+		// Pool ran dry, build one on the spot
+		return CreateState();
+	}
+
+	bool ScriptStatePool::Initialize()
+	{
+		// Compile spacelib once, every state will then load the bytecode instead of parsing the source again
+		Nz::LuaInstance compiler;
+		compiler.LoadLibraries(Nz::LuaLib_String);
+
+		if (!compiler.Execute("spacelibBytecode = string.dump(assert(loadfile(\"spacelib.lua\")))"))
+		{
+			std::cerr << "Failed to compile spacelib.lua: " << compiler.GetLastError() << std::endl;
+			return false;
+		}
+
+		compiler.GetGlobal("spacelibBytecode");
+
+		std::size_t bytecodeSize;
+		const char* bytecode = compiler.CheckString(-1, &bytecodeSize);
+		s_spacelibBytecode.assign(bytecode, bytecodeSize);
+
+		compiler.Pop();
+
+		Refill(PoolSize);
+
+		return true;
+	}
+
+	void ScriptStatePool::Refill(std::size_t maxCount)
+	{
+		std::size_t missingCount;
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			missingCount = std::min(PoolSize - std::min(PoolSize, s_states.size()), maxCount);
+		}
+
+		for (std::size_t i = 0; i < missingCount; ++i)
+		{
+			std::unique_ptr<Nz::LuaInstance> state = CreateState();
+			if (!state)
+				break;
+
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_states.emplace_back(std::move(state));
+		}
+	}
+
+	void ScriptStatePool::Uninitialize()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_states.clear();
+		s_spacelibBytecode.clear();
+	}
+
+	std::unique_ptr<Nz::LuaInstance> ScriptStatePool::CreateState()
+	{
+		std::unique_ptr<Nz::LuaInstance> state = std::make_unique<Nz::LuaInstance>();
+		state->SetMemoryLimit(1'000'000);
+		state->SetTimeLimit(50);
+
+		state->LoadLibraries(Nz::LuaLib_Math | Nz::LuaLib_String | Nz::LuaLib_Table | Nz::LuaLib_Utf8);
+
+		state->PushNil();
+		state->SetGlobal("collectgarbage");
+
+		state->PushNil();
+		state->SetGlobal("dofile");
+
+		state->PushNil();
+		state->SetGlobal("loadfile");
+
+		if (!state->ExecuteFromMemory(s_spacelibBytecode.data(), s_spacelibBytecode.size()))
+		{
+			std::cerr << "Failed to load spacelib: " << state->GetLastError() << std::endl;
+			return nullptr;
+		}
+
+		return state;
+	}
+
+	std::mutex ScriptStatePool::s_mutex;
+	std::string ScriptStatePool::s_spacelibBytecode;
+	std::vector<std::unique_ptr<Nz::LuaInstance>> ScriptStatePool::s_states;
+}
@@ -0,0 +1,48 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SCRIPTING_SCRIPT_STATE_POOL_HPP
+#define EREWHON_SCRIPTING_SCRIPT_STATE_POOL_HPP
+
+#include <Nazara/Lua/LuaInstance.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	// Keeps sandboxed Lua states with spacelib already loaded, ready to be handed to bots
+	class ScriptStatePool
+	{
+		public:
+			ScriptStatePool() = delete;
+			~ScriptStatePool() = delete;
+
+			static std::unique_ptr<Nz::LuaInstance> Acquire();
+
+			static inline std::size_t GetAvailableCount();
+
+			static bool Initialize();
+
+			static void Refill(std::size_t maxCount);
+
+			static void Uninitialize();
+
+			static constexpr std::size_t PoolSize = 32;
+
+		private:
+			static std::unique_ptr<Nz::LuaInstance> CreateState();
+
+			static std::mutex s_mutex;
+			static std::string s_spacelibBytecode;
+			static std::vector<std::unique_ptr<Nz::LuaInstance>> s_states;
+	};
+}
+
+#include <Server/Scripting/ScriptStatePool.inl>
+
+#endif // EREWHON_SCRIPTING_SCRIPT_STATE_POOL_HPP
@@ -0,0 +1,14 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Scripting/ScriptStatePool.hpp>
+
+namespace ewn
+{
+	inline std::size_t ScriptStatePool::GetAvailableCount()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		return s_states.size();
+	}
+}
@@ -9,16 +9,31 @@
 #include <Server/DatabaseLoader.hpp>
 #include <Server/Database/Database.hpp>
 #include <Server/Player.hpp>
+#include <Server/Scripting/ScriptStatePool.hpp>
 #include <argon2/argon2.h>
+#include <algorithm>
 #include <bitset>
+#include <chrono>
 #include <cctype>
 #include <iostream>
 #include <regex>
+#include <thread>
 
 namespace ewn
 {
 	ServerApplication::ServerApplication() :
+	m_arenaUpdateTime(0.f),
+	m_finishedArenaCount(0),
+	m_nextArenaIndex(0),
+	m_maxCatchUpTicks(5),
 	m_playerPool(sizeof(Player)),
+	m_nextTickIndex(0),
+	m_nextTickTime(0),
+	m_skippedTickCount(0),
+	m_tickCount(0),
+	m_tickEpoch(0),
+	m_tickOverrunCount(0),
+	m_tickRate(60),
 	m_chatCommandStore(this),
 	m_commandStore(this),
 	m_nextSessionId(0)
@@ -26,6 +41,11 @@ namespace ewn
 		RegisterConfigOptions();
 		RegisterNetworkedStrings();
 
+		// Hull and module lists are the same for every client, serialize them once per store load
+		m_onHullStoreLoadedSlot.Connect(m_spaceshipHullStore.OnStoreLoaded, [this](DatabaseStore*) { m_hullListPacket.reset(); });
+		m_onModuleStoreLoadedSlot.Connect(m_moduleStore.OnStoreLoaded, [this](DatabaseStore*) { m_moduleListPacket.reset(); });
+		m_onVisualMeshStoreLoadedSlot.Connect(m_visualMeshStore.OnStoreLoaded, [this](DatabaseStore*) { m_hullListPacket.reset(); });
+
 		m_arenas.emplace_back(std::make_unique<Arena>(this, "Le Royaume de Belgique", "arena.lua"));
 		m_arenas.emplace_back(std::make_unique<Arena>(this, "La Cinquième République", "arena.lua"));
 	}
@@ -73,9 +93,37 @@ namespace ewn
 
 	bool ServerApplication::Run()
 	{
-		float updateTime = GetUpdateTime();
-		for (const auto& arenaPtr : m_arenas)
-			arenaPtr->Update(updateTime);
+		WaitForNextTick();
+
+		Nz::UInt64 now = m_tickClock.GetMicroseconds();
+
+		// Run every tick whose deadline passed, giving up on the ones we can't catch up with
+		std::size_t catchUpCount = 0;
+		while (now >= m_nextTickTime)
+		{
+			if (catchUpCount >= m_maxCatchUpTicks)
+			{
+				Nz::UInt64 nextTickIndex = (now - m_tickEpoch) * m_tickRate / 1'000'000 + 1;
+				m_skippedTickCount += nextTickIndex - m_nextTickIndex;
+
+				m_nextTickIndex = nextTickIndex;
+				m_nextTickTime = ComputeTickTime(m_nextTickIndex);
+				break;
+			}
+
+			UpdateArenas(1.f / m_tickRate);
+
+			Nz::UInt64 tickEnd = m_tickClock.GetMicroseconds();
+			if ((tickEnd - now) * m_tickRate > 1'000'000)
+				m_tickOverrunCount++;
+
+			m_nextTickIndex++;
+			m_nextTickTime = ComputeTickTime(m_nextTickIndex);
+			m_tickCount++;
+
+			catchUpCount++;
+			now = tickEnd;
+		}
 
 		m_globalDatabase->Poll();
 
@@ -83,9 +131,109 @@ namespace ewn
 		while (m_callbackQueue.try_dequeue(func))
 			func();
 
+		// Replace script states consumed by spawned bots, a few at a time to keep frames short
+		ScriptStatePool::Refill(2);
+
 		return BaseApplication::Run();
 	}
 
+	const NetworkReactor::SharedPacket& ServerApplication::GetHullListPacket()
+	{
+		if (!m_hullListPacket)
+		{
+			Packets::HullList hullList;
+			hullList.hulls.reserve(m_spaceshipHullStore.GetEntryCount());
+
+			for (std::size_t i = 0; i < m_spaceshipHullStore.GetEntryCount(); ++i)
+			{
+				if (m_spaceshipHullStore.IsEntryLoaded(i))
+				{
+					std::size_t visualMeshId = m_spaceshipHullStore.GetEntryVisualMeshId(i);
+
+					auto& hullInfo = hullList.hulls.emplace_back();
+					hullInfo.description = m_spaceshipHullStore.GetEntryDescription(i);
+					hullInfo.hullId = static_cast<Nz::UInt32>(i);
+					hullInfo.hullModelPathId = m_stringStore.GetStringIndex(m_visualMeshStore.GetEntryFilePath(visualMeshId));
+					hullInfo.name = m_spaceshipHullStore.GetEntryName(i);
+
+					hullInfo.slots.reserve(m_spaceshipHullStore.GetEntrySlotCount(i));
+
+					for (std::size_t j = 0; j < m_spaceshipHullStore.GetEntrySlotCount(i); ++j)
+					{
+						auto& slotInfo = hullInfo.slots.emplace_back();
+						slotInfo.type = m_spaceshipHullStore.GetEntrySlotModuleType(i, j);
+					}
+				}
+			}
+
+			std::shared_ptr<Nz::NetPacket> packet = std::make_shared<Nz::NetPacket>();
+			m_commandStore.SerializePacket(*packet, hullList);
+
+			m_hullListPacket = std::move(packet);
+		}
+
+		return m_hullListPacket;
+	}
+
+	const NetworkReactor::SharedPacket& ServerApplication::GetModuleListPacket()
+	{
+		if (!m_moduleListPacket)
+		{
+			Packets::ModuleList moduleList;
+
+			for (std::size_t i = 0; i < m_moduleStore.GetEntryCount(); ++i)
+			{
+				if (m_moduleStore.IsEntryLoaded(i))
+				{
+					ModuleType type = m_moduleStore.GetEntryType(i);
+
+					auto it = std::find_if(moduleList.modules.begin(), moduleList.modules.end(), [type](const Packets::ModuleList::ModuleTypeInfo& typeInfo)
+					{
+						return typeInfo.type == type;
+					});
+
+					if (it == moduleList.modules.end())
+					{
+						auto& moduleTypeInfo = moduleList.modules.emplace_back();
+						moduleTypeInfo.type = type;
+
+						it = moduleList.modules.end() - 1;
+					}
+
+					auto& moduleTypeInfo = *it;
+					auto& moduleInfo = moduleTypeInfo.availableModules.emplace_back();
+					moduleInfo.moduleId = static_cast<Nz::UInt32>(i);
+					moduleInfo.moduleName = m_moduleStore.GetEntryName(i);
+				}
+			}
+
+			std::shared_ptr<Nz::NetPacket> packet = std::make_shared<Nz::NetPacket>();
+			m_commandStore.SerializePacket(*packet, moduleList);
+
+			m_moduleListPacket = std::move(packet);
+		}
+
+		return m_moduleListPacket;
+	}
+
+	void ServerApplication::HandleArenaStateAck(std::size_t peerId, const Packets::ArenaStateAck& data)
+	{
+		Player* player = m_players[peerId];
+		if (!player->IsAuthenticated())
+			return;
+
+		Arena* arena = player->GetArena();
+		if (!arena)
+			return;
+
+		// A late ack from the previous arena would point to an unrelated state of this one
+		arena->PostCommand([ply = player->CreateHandle(), arena, stateId = data.stateId]()
+		{
+			if (ply && ply->GetArena() == arena)
+				ply->AcknowledgeArenaState(stateId);
+		});
+	}
+
 	void ServerApplication::HandleCreateSpaceship(std::size_t peerId, const Packets::CreateSpaceship& data)
 	{
 		Player* player = m_players[peerId];
@@ -172,6 +320,8 @@ namespace ewn
 				return;
 			}
 
+			m_spaceshipCache->Invalidate(ply->GetDatabaseId());
+
 			ply->SendPacket(Packets::CreateSpaceshipSuccess{});
 		});
 	}
@@ -182,10 +332,12 @@ namespace ewn
 		if (!player->IsAuthenticated())
 			return;
 
-		m_globalDatabase->ExecuteQuery("DeleteSpaceship", { Nz::Int32(player->GetDatabaseId()), data.spaceshipName }, [this, sessionId = player->GetSessionId(), spaceshipName = data.spaceshipName](DatabaseResult& result)
+		m_globalDatabase->ExecuteQuery("DeleteSpaceship", { Nz::Int32(player->GetDatabaseId()), data.spaceshipName }, [this, ownerId = player->GetDatabaseId(), sessionId = player->GetSessionId(), spaceshipName = data.spaceshipName](DatabaseResult& result)
 		{
 			if (!result)
 				std::cerr << "Delete spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
+			else
+				m_spaceshipCache->Invalidate(ownerId);
 
 			Player* ply = GetPlayerBySession(sessionId);
 			if (!ply)
@@ -236,6 +388,9 @@ namespace ewn
 
 		m_sessionIdToPlayer.erase(m_players[peerId]->GetSessionId());
 
+		if (m_players[peerId]->IsAuthenticated())
+			m_spaceshipCache->Evict(m_players[peerId]->GetDatabaseId());
+
 		m_playerPool.Delete(m_players[peerId]);
 		m_players[peerId] = nullptr;
 	}
@@ -336,6 +491,8 @@ namespace ewn
 	{
 		m_globalDatabase.emplace(std::move(dbHost), port, std::move(dbUser), std::move(dbPassword), std::move(dbName));
 		m_globalDatabase->SpawnWorkers(workerCount);
+
+		m_spaceshipCache.emplace(*m_globalDatabase);
 	}
 
 	void ServerApplication::OnConfigLoaded(const ConfigFile& config)
@@ -349,6 +506,18 @@ namespace ewn
 
 		std::size_t gameWorkerCount = m_config.GetIntegerOption<std::size_t>("Game.WorkerCount");
 
+		m_maxCatchUpTicks = m_config.GetIntegerOption<std::size_t>("Game.MaxCatchUpTicks");
+		m_tickRate = m_config.GetIntegerOption<Nz::UInt64>("Game.TickRate");
+
+		// Tick times are computed from the tick index (to prevent rounding errors from accumulating), restart counting from the next tick
+		m_tickEpoch = m_nextTickTime;
+		m_nextTickIndex = 0;
+
+		// Arenas are created before the config gets loaded
+		float interestRadius = m_config.GetFloatOption<float>("Game.InterestRadius");
+		for (auto& arena : m_arenas)
+			arena->SetInterestRadius(interestRadius);
+
 		InitGameWorkers(gameWorkerCount);
 		InitGlobalDatabase(dbWorkerCount, dbHost, dbPort, dbUser, dbPassword, dbName);
 	}
@@ -610,7 +779,26 @@ namespace ewn
 		if (!player->IsAuthenticated())
 			return;
 
-		player->UpdateInput(data.inputTime, data.direction, data.rotation);
+		Arena* arena = player->GetArena();
+		if (!arena)
+			return;
+
+		arena->PostCommand([ply = player->CreateHandle(), arena, data]()
+		{
+			if (!ply || ply->GetArena() != arena)
+				return;
+
+			// Oldest first, inputs we already received are skipped by the player
+			Nz::UInt64 inputTime = data.inputTime;
+			for (auto it = data.inputs.rbegin(); it != data.inputs.rend(); ++it)
+			{
+				Nz::UInt32 timeOffset = it->timeOffset;
+				if (timeOffset > inputTime)
+					continue;
+
+				ply->UpdateInput(inputTime - timeOffset, it->direction, it->rotation);
+			}
+		});
 	}
 
 	void ServerApplication::HandlePlayerShoot(std::size_t peerId, const Packets::PlayerShoot& data)
@@ -619,7 +807,15 @@ namespace ewn
 		if (!player->IsAuthenticated())
 			return;
 
-		player->Shoot();
+		Arena* arena = player->GetArena();
+		if (!arena)
+			return;
+
+		arena->PostCommand([ply = player->CreateHandle(), arena]()
+		{
+			if (ply && ply->GetArena() == arena && ply->GetControlledEntity())
+				ply->Shoot();
+		});
 	}
 
 	void ServerApplication::HandleQueryArenaList(std::size_t peerId, const Packets::QueryArenaList& data)
@@ -646,32 +842,7 @@ namespace ewn
 		if (!player->IsAuthenticated())
 			return;
 
-		Packets::HullList hullList;
-		hullList.hulls.reserve(m_spaceshipHullStore.GetEntryCount());
-
-		for (std::size_t i = 0; i < m_spaceshipHullStore.GetEntryCount(); ++i)
-		{
-			if (m_spaceshipHullStore.IsEntryLoaded(i))
-			{
-				std::size_t visualMeshId = m_spaceshipHullStore.GetEntryVisualMeshId(i);
-
-				auto& hullInfo = hullList.hulls.emplace_back();
-				hullInfo.description = m_spaceshipHullStore.GetEntryDescription(i);
-				hullInfo.hullId = static_cast<Nz::UInt32>(i);
-				hullInfo.hullModelPathId = m_stringStore.GetStringIndex(m_visualMeshStore.GetEntryFilePath(i));
-				hullInfo.name = m_spaceshipHullStore.GetEntryName(i);
-
-				hullInfo.slots.reserve(m_spaceshipHullStore.GetEntrySlotCount(i));
-
-				for (std::size_t j = 0; j < m_spaceshipHullStore.GetEntrySlotCount(i); ++j)
-				{
-					auto& slotInfo = hullInfo.slots.emplace_back();
-					slotInfo.type = m_spaceshipHullStore.GetEntrySlotModuleType(i, j);
-				}
-			}
-		}
-
-		player->SendPacket(hullList);
+		player->SendSharedPacket<Packets::HullList>(GetHullListPacket());
 	}
 
 	void ServerApplication::HandleQueryModuleList(std::size_t peerId, const Packets::QueryModuleList& data)
@@ -680,35 +851,7 @@ namespace ewn
 		if (!player->IsAuthenticated())
 			return;
 
-		Packets::ModuleList moduleList;
-
-		for (std::size_t i = 0; i < m_moduleStore.GetEntryCount(); ++i)
-		{
-			if (m_moduleStore.IsEntryLoaded(i))
-			{
-				ModuleType type = m_moduleStore.GetEntryType(i);
-
-				auto it = std::find_if(moduleList.modules.begin(), moduleList.modules.end(), [type](const Packets::ModuleList::ModuleTypeInfo& typeInfo)
-				{
-					return typeInfo.type == type;
-				});
-
-				if (it == moduleList.modules.end())
-				{
-					auto& moduleTypeInfo = moduleList.modules.emplace_back();
-					moduleTypeInfo.type = type;
-
-					it = moduleList.modules.end() - 1;
-				}
-
-				auto& moduleTypeInfo = *it;
-				auto& moduleInfo = moduleTypeInfo.availableModules.emplace_back();
-				moduleInfo.moduleId = static_cast<Nz::UInt32>(i);
-				moduleInfo.moduleName = m_moduleStore.GetEntryName(i);
-			}
-		}
-
-		player->SendPacket(moduleList);
+		player->SendSharedPacket<Packets::ModuleList>(GetModuleListPacket());
 	}
 
 	void ServerApplication::HandleQuerySpaceshipInfo(std::size_t peerId, const Packets::QuerySpaceshipInfo& data)
@@ -720,76 +863,35 @@ namespace ewn
 		if (data.spaceshipName.empty())
 			return;
 
-		m_globalDatabase->ExecuteQuery("FindSpaceshipByOwnerIdAndName", { player->GetDatabaseId(), data.spaceshipName }, [&, sessionId = player->GetSessionId()](DatabaseResult& result)
+		m_spaceshipCache->FindSpaceship(player->GetDatabaseId(), data.spaceshipName, [this, sessionId = player->GetSessionId()](bool succeeded, const SpaceshipCache::Spaceship* spaceship)
 		{
 			Player* ply = GetPlayerBySession(sessionId);
 			if (!ply)
 				return; //< Player has disconnected, ignore
 
-			if (!result)
-			{
-				std::cerr << "FindSpaceshipByOwnerIdAndName failed: " << result.GetLastErrorMessage() << std::endl;
-
-				ply->SendPacket(Packets::SpaceshipInfo{});
-				return;
-			}
-
-			if (result.GetRowCount() == 0)
+			if (!succeeded || !spaceship)
 			{
 				ply->SendPacket(Packets::SpaceshipInfo{});
 				return;
 			}
 
-			Nz::Int32 spaceshipId = std::get<Nz::Int32>(result.GetValue(0));
-
-			Nz::UInt32 spaceshipHullId = static_cast<Nz::UInt32>(std::get<Nz::Int32>(result.GetValue(2)));
+			Nz::UInt32 spaceshipHullId = static_cast<Nz::UInt32>(spaceship->hullId);
 			std::size_t visualMeshId = m_spaceshipHullStore.GetEntryVisualMeshId(spaceshipHullId);
 
-			m_globalDatabase->ExecuteQuery("FindSpaceshipModulesBySpaceshipId", { spaceshipId }, [=](DatabaseResult& result)
-			{
-				if (!ply)
-					return; //< Player has disconnected, ignore
-
-				Packets::SpaceshipInfo spaceshipInfo;
+			Packets::SpaceshipInfo spaceshipInfo;
+			spaceshipInfo.hullId = spaceshipHullId;
+			spaceshipInfo.hullModelPath = m_visualMeshStore.GetEntryFilePath(visualMeshId);
 
-				if (result.IsValid())
-				{
-					spaceshipInfo.hullId = spaceshipHullId;
-					spaceshipInfo.hullModelPath = m_visualMeshStore.GetEntryFilePath(visualMeshId);
-
-					if (!result)
-					{
-						ply->PrintMessage("Server: Failed to retrieve spaceship modules, please contact an administrator");
-						return;
-					}
-
-					// Spaceship actual modules
-					try
-					{
-						std::size_t moduleCount = result.GetRowCount();
-
-						spaceshipInfo.modules.reserve(moduleCount);
-						for (std::size_t i = 0; i < moduleCount; ++i)
-						{
-							Nz::UInt32 moduleId = static_cast<Nz::UInt32>(std::get<Nz::Int32>(result.GetValue(0, i)));
-
-							auto& moduleInfo = spaceshipInfo.modules.emplace_back();
-							moduleInfo.type = m_moduleStore.GetEntryType(moduleId);
-							moduleInfo.currentModule = moduleId;
-						}
-					}
-					catch (const std::exception& e)
-					{
-						std::cerr << "Failed to retrieve spaceship modules: " << e.what() << std::endl;
-						ply->SendPacket(Packets::SpaceshipInfo{});
-						return;
-					}
-				}
-				else
-					std::cerr << "FindSpaceshipByOwnerIdAndName failed:" << result.GetLastErrorMessage() << std::endl;
+			// Spaceship actual modules
+			spaceshipInfo.modules.reserve(spaceship->moduleIds.size());
+			for (std::size_t moduleId : spaceship->moduleIds)
+			{
+				auto& moduleInfo = spaceshipInfo.modules.emplace_back();
+				moduleInfo.type = m_moduleStore.GetEntryType(moduleId);
+				moduleInfo.currentModule = static_cast<Nz::UInt32>(moduleId);
+			}
 
-				ply->SendPacket(spaceshipInfo);
-			});
+			ply->SendPacket(spaceshipInfo);
 		});
 	}
 
@@ -977,7 +1079,7 @@ namespace ewn
 				return;
 		}
 
-		m_globalDatabase->ExecuteQuery("FindSpaceshipIdByOwnerIdAndName", { player->GetDatabaseId(), data.spaceshipName }, [=, sessionId = player->GetSessionId()](DatabaseResult& result)
+		m_globalDatabase->ExecuteQuery("FindSpaceshipIdByOwnerIdAndName", { player->GetDatabaseId(), data.spaceshipName }, [=, ownerId = player->GetDatabaseId(), sessionId = player->GetSessionId()](DatabaseResult& result)
 		{
 			if (!result)
 			{
@@ -1031,8 +1133,11 @@ namespace ewn
 
 			transaction.AppendPreparedStatement("UpdateSpaceshipUpdateDate", { spaceshipId });
 
-			m_globalDatabase->ExecuteTransaction(std::move(transaction), [this, sessionId](bool transactionSucceeded, std::vector<DatabaseResult>& queryResults)
+			m_globalDatabase->ExecuteTransaction(std::move(transaction), [this, ownerId, sessionId](bool transactionSucceeded, std::vector<DatabaseResult>& queryResults)
 			{
+				if (transactionSucceeded)
+					m_spaceshipCache->Invalidate(ownerId);
+
 				Player* ply = GetPlayerBySession(sessionId);
 				if (!ply)
 					return;
@@ -1063,6 +1168,11 @@ namespace ewn
 			for (std::size_t i = 0; i < reactorCount; ++i)
 				AddReactor(std::make_unique<NetworkReactor>(m_peerPerReactor * i, protocol, Nz::UInt16(firstPort + i), clientPerReactor));
 
+			// Don't try to catch up with the time spent loading
+			m_tickEpoch = m_tickClock.GetMicroseconds();
+			m_nextTickIndex = 0;
+			m_nextTickTime = m_tickEpoch;
+
 			return true;
 		}
 		catch (const std::exception& e)
@@ -1072,6 +1182,17 @@ namespace ewn
 		}
 	}
 
+	void ServerApplication::WaitForNextTick()
+	{
+		// Sleeping is only precise to about a millisecond, spin the end of the wait to start the tick on time
+		Nz::UInt64 now = m_tickClock.GetMicroseconds();
+		if (now + TickSpinDuration < m_nextTickTime)
+			std::this_thread::sleep_for(std::chrono::microseconds(m_nextTickTime - now - TickSpinDuration));
+
+		while (m_tickClock.GetMicroseconds() < m_nextTickTime)
+			std::this_thread::yield();
+	}
+
 	void ServerApplication::RegisterConfigOptions()
 	{
 		m_config.RegisterStringOption("AssetsFolder");
@@ -1090,8 +1211,12 @@ namespace ewn
 		m_config.RegisterIntegerOption("Security.HashLength");
 		m_config.RegisterStringOption("Security.PasswordSalt");
 
+		m_config.RegisterFloatOption("Game.InterestRadius", 0.0, 100000.0);
+		m_config.RegisterIntegerOption("Game.MaxCatchUpTicks", 1, 100);
 		m_config.RegisterIntegerOption("Game.MaxClients", 0, 4096); //< 4096 due to ENet limitation
 		m_config.RegisterIntegerOption("Game.Port", 1, 0xFFFF);
+		m_config.RegisterIntegerOption("Game.ReactorCount", 1, 64);
+		m_config.RegisterIntegerOption("Game.TickRate", 1, 1000);
 		m_config.RegisterIntegerOption("Game.WorkerCount", 1, 100);
 	}
 
@@ -1106,4 +1231,37 @@ namespace ewn
 		m_stringStore.RegisterString("explosion_smoke");
 		m_stringStore.RegisterString("explosion_wave");
 	}
+	void ServerApplication::RunArenaUpdates()
+	{
+		std::size_t arenaCount = m_arenas.size();
+
+		std::size_t arenaIndex;
+		while ((arenaIndex = m_nextArenaIndex.fetch_add(1, std::memory_order_acq_rel)) < arenaCount)
+		{
+			m_arenas[arenaIndex]->Update(m_arenaUpdateTime.load(std::memory_order_relaxed));
+
+			m_finishedArenaCount.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	void ServerApplication::UpdateArenas(float elapsedTime)
+	{
+		std::size_t arenaCount = m_arenas.size();
+		if (arenaCount == 0)
+			return;
+
+		m_arenaUpdateTime.store(elapsedTime, std::memory_order_relaxed);
+		m_finishedArenaCount.store(0, std::memory_order_relaxed);
+		m_nextArenaIndex.store(0, std::memory_order_release);
+
+		// Game workers pick arenas up while the main thread updates its own share, so a busy worker (hashing a password for example) never stalls the tick
+		std::size_t helperCount = std::min(m_workers.size(), arenaCount - 1);
+		for (std::size_t i = 0; i < helperCount; ++i)
+			DispatchWork([this]() { RunArenaUpdates(); });
+
+		RunArenaUpdates();
+
+		while (m_finishedArenaCount.load(std::memory_order_acquire) < arenaCount)
+			std::this_thread::yield();
+	}
 }
@@ -9,16 +9,19 @@
 
 #include <Shared/BaseApplication.hpp>
 #include <Shared/Protocol/NetworkStringStore.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Nazara/Core/MemoryPool.hpp>
 #include <Server/Arena.hpp>
 #include <Server/GameWorker.hpp>
 #include <Server/GlobalDatabase.hpp>
 #include <Server/ServerCommandStore.hpp>
 #include <Server/ServerChatCommandStore.hpp>
+#include <Server/SpaceshipCache.hpp>
 #include <Server/Store/CollisionMeshStore.hpp>
 #include <Server/Store/ModuleStore.hpp>
 #include <Server/Store/SpaceshipHullStore.hpp>
 #include <Server/Store/VisualMeshStore.hpp>
+#include <atomic>
 #include <optional>
 #include <vector>
 
@@ -41,19 +44,26 @@ namespace ewn
 
 			inline CollisionMeshStore& GetCollisionMeshStore();
 			inline const CollisionMeshStore& GetCollisionMeshStore() const;
+			inline const ServerCommandStore& GetCommandStore() const;
 			inline Database& GetGlobalDatabase();
 			inline ModuleStore& GetModuleStore();
 			inline const ModuleStore& GetModuleStore() const;
 			inline std::size_t GetPeerPerReactor() const;
 			inline Player* GetPlayerBySession(std::size_t sessionId);
 			inline const NetworkStringStore& GetNetworkStringStore() const;
+			inline Nz::UInt64 GetSkippedTickCount() const;
+			inline SpaceshipCache& GetSpaceshipCache();
 			inline SpaceshipHullStore& GetSpaceshipHullStore();
 			inline const SpaceshipHullStore& GetSpaceshipHullStore() const;
+			inline Nz::UInt64 GetTickCount() const;
+			inline Nz::UInt64 GetTickOverrunCount() const;
+			inline std::size_t GetWorkerCount() const;
 
 			bool LoadDatabase();
 
 			bool Run() override;
 
+			void HandleArenaStateAck(std::size_t peerId, const Packets::ArenaStateAck& data);
 			void HandleCreateSpaceship(std::size_t peerId, const Packets::CreateSpaceship& data);
 			void HandleDeleteSpaceship(std::size_t peerId, const Packets::DeleteSpaceship& data);
 			void HandleLogin(std::size_t peerId, const Packets::Login& data);
@@ -76,10 +86,16 @@ namespace ewn
 
 			bool SetupNetwork(std::size_t clientPerReactor, std::size_t reactorCount, Nz::NetProtocol protocol, Nz::UInt16 firstPort);
 
+			static constexpr Nz::UInt64 TickSpinDuration = 2000; //< Microseconds spent spinning before a tick instead of sleeping
+
 		private:
 			using CallbackQueue = moodycamel::ConcurrentQueue<ServerCallback>;
 			using WorkerQueue = moodycamel::BlockingConcurrentQueue<WorkerFunction>;
 
+			inline Nz::UInt64 ComputeTickTime(Nz::UInt64 tickIndex) const;
+
+			const NetworkReactor::SharedPacket& GetHullListPacket();
+			const NetworkReactor::SharedPacket& GetModuleListPacket();
 			inline WorkerQueue& GetWorkerQueue();
 
 			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data) override;
@@ -96,14 +112,32 @@ namespace ewn
 			void RegisterConfigOptions();
 			void RegisterNetworkedStrings();
 
+			void RunArenaUpdates();
+			void UpdateArenas(float elapsedTime);
+
+			void WaitForNextTick();
+
+			std::atomic<float> m_arenaUpdateTime;
+			std::atomic_size_t m_finishedArenaCount;
+			std::atomic_size_t m_nextArenaIndex;
+			std::size_t m_maxCatchUpTicks;
 			std::optional<GlobalDatabase> m_globalDatabase;
+			std::optional<SpaceshipCache> m_spaceshipCache;
 			std::size_t m_peerPerReactor;
 			std::size_t m_nextSessionId;
 			std::unordered_map<std::size_t /*sessionId*/, std::size_t> m_sessionIdToPlayer;
 			std::vector<std::unique_ptr<GameWorker>> m_workers;
 			std::vector<Player*> m_players;
 			std::vector<std::unique_ptr<Arena>> m_arenas;
+			Nz::Clock m_tickClock;
 			Nz::MemoryPool m_playerPool;
+			Nz::UInt64 m_nextTickIndex; //< Since m_tickEpoch
+			Nz::UInt64 m_nextTickTime;
+			Nz::UInt64 m_skippedTickCount;
+			Nz::UInt64 m_tickCount;
+			Nz::UInt64 m_tickEpoch;
+			Nz::UInt64 m_tickOverrunCount;
+			Nz::UInt64 m_tickRate;
 			CallbackQueue m_callbackQueue;
 			CollisionMeshStore m_collisionMeshStore;
 			ModuleStore m_moduleStore;
@@ -113,6 +147,12 @@ namespace ewn
 			SpaceshipHullStore m_spaceshipHullStore;
 			VisualMeshStore m_visualMeshStore;
 			WorkerQueue m_workerQueue;
+			NetworkReactor::SharedPacket m_hullListPacket;
+			NetworkReactor::SharedPacket m_moduleListPacket;
+
+			NazaraSlot(DatabaseStore, OnStoreLoaded, m_onHullStoreLoadedSlot);
+			NazaraSlot(DatabaseStore, OnStoreLoaded, m_onModuleStoreLoadedSlot);
+			NazaraSlot(DatabaseStore, OnStoreLoaded, m_onVisualMeshStoreLoadedSlot);
 	};
 }
 
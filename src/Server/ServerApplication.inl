@@ -6,6 +6,11 @@
 
 namespace ewn
 {
+	inline Nz::UInt64 ServerApplication::ComputeTickTime(Nz::UInt64 tickIndex) const
+	{
+		return m_tickEpoch + tickIndex * 1'000'000 / m_tickRate;
+	}
+
 	inline void ServerApplication::DispatchWork(WorkerFunction workFunc)
 	{
 		m_workerQueue.enqueue(std::move(workFunc));
@@ -27,6 +32,11 @@ namespace ewn
 		return m_collisionMeshStore;
 	}
 
+	inline const ServerCommandStore& ServerApplication::GetCommandStore() const
+	{
+		return m_commandStore;
+	}
+
 	inline ModuleStore& ServerApplication::GetModuleStore()
 	{
 		return m_moduleStore;
@@ -56,6 +66,17 @@ namespace ewn
 		return m_stringStore;
 	}
 
+	inline Nz::UInt64 ServerApplication::GetSkippedTickCount() const
+	{
+		return m_skippedTickCount;
+	}
+
+	inline SpaceshipCache& ServerApplication::GetSpaceshipCache()
+	{
+		assert(m_spaceshipCache.has_value());
+		return *m_spaceshipCache;
+	}
+
 	inline SpaceshipHullStore& ServerApplication::GetSpaceshipHullStore()
 	{
 		return m_spaceshipHullStore;
@@ -66,6 +87,21 @@ namespace ewn
 		return m_spaceshipHullStore;
 	}
 
+	inline Nz::UInt64 ServerApplication::GetTickCount() const
+	{
+		return m_tickCount;
+	}
+
+	inline Nz::UInt64 ServerApplication::GetTickOverrunCount() const
+	{
+		return m_tickOverrunCount;
+	}
+
+	inline std::size_t ServerApplication::GetWorkerCount() const
+	{
+		return m_workers.size();
+	}
+
 	inline void ServerApplication::RegisterCallback(ServerCallback callback)
 	{
 		m_callbackQueue.enqueue(std::move(callback));
@@ -29,20 +29,34 @@ namespace ewn
 
 	void ServerChatCommandStore::BuildStore(ServerApplication* /*app*/)
 	{
+		RegisterCommand("cachestats", &ServerChatCommandStore::HandleCacheStats);
 		RegisterCommand("clearbots", &ServerChatCommandStore::HandleClearBots);
 		RegisterCommand("crashserver", &ServerChatCommandStore::HandleCrashServer);
 		RegisterCommand("debugparticles", &ServerChatCommandStore::HandleDebugParticles);
 		RegisterCommand("kamikaze", &ServerChatCommandStore::HandleSuicide);
 		RegisterCommand("kick", &ServerChatCommandStore::HandleKickPlayer);
+		RegisterCommand("netstats", &ServerChatCommandStore::HandleNetStats);
 		RegisterCommand("reloadmodules", &ServerChatCommandStore::HandleReloadModules);
 		RegisterCommand("resetarena", &ServerChatCommandStore::HandleResetArena);
 		RegisterCommand("spawnfleet", &ServerChatCommandStore::HandleSpawnFleet);
 		RegisterCommand("stopserver", &ServerChatCommandStore::HandleStopServer);
 		RegisterCommand("suicide", &ServerChatCommandStore::HandleSuicide);
 		RegisterCommand("spawnbot", &ServerChatCommandStore::HandleSpawnBot);
+		RegisterCommand("tickstats", &ServerChatCommandStore::HandleTickStats);
 		RegisterCommand("updatepermission", &ServerChatCommandStore::HandleUpdatePermission);
 	}
 
+	bool ServerChatCommandStore::HandleCacheStats(ServerApplication* app, Player* player)
+	{
+		if (player->GetPermissionLevel() < 20)
+			return false;
+
+		const SpaceshipCache& spaceshipCache = app->GetSpaceshipCache();
+		player->PrintMessage("Spaceship cache: " + std::to_string(spaceshipCache.GetHitCount()) + " hit(s), " + std::to_string(spaceshipCache.GetMissCount()) + " miss(es)");
+
+		return true;
+	}
+
 	bool ServerChatCommandStore::HandleClearBots(ServerApplication* /*app*/, Player* player)
 	{
 		player->ClearBots();
@@ -95,6 +109,22 @@ namespace ewn
 		return true;
 	}
 
+	bool ServerChatCommandStore::HandleNetStats(ServerApplication* app, Player* player)
+	{
+		if (player->GetPermissionLevel() < 20)
+			return false;
+
+		for (std::size_t i = 0; i < app->GetReactorCount(); ++i)
+		{
+			NetworkReactor::QueueMetrics metrics = app->GetReactorQueueMetrics(i);
+			player->PrintMessage("Reactor #" + std::to_string(i) + ": " +
+			                     std::to_string(metrics.incomingDepth) + " incoming (peak " + std::to_string(metrics.peakIncomingCount) + "), " +
+			                     std::to_string(metrics.outgoingDepth) + " outgoing (peak " + std::to_string(metrics.peakOutgoingCount) + ")");
+		}
+
+		return true;
+	}
+
 	bool ServerChatCommandStore::HandleReloadModules(ServerApplication* app, Player* player)
 	{
 		if (player->GetPermissionLevel() < 30)
@@ -139,78 +169,40 @@ namespace ewn
 			return false;
 		}
 
-		app->GetGlobalDatabase().ExecuteQuery("FindSpaceshipByOwnerIdAndName", { Nz::Int32(player->GetDatabaseId()), spaceshipName }, [app, spaceshipCount, sessionId = player->GetSessionId(), spaceshipName](DatabaseResult& result)
+		app->GetSpaceshipCache().FindSpaceship(player->GetDatabaseId(), spaceshipName, [app, spaceshipCount, sessionId = player->GetSessionId(), spaceshipName](bool succeeded, const SpaceshipCache::Spaceship* spaceship)
 		{
-			if (!result)
-				std::cerr << "Find spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
-
 			Player* ply = app->GetPlayerBySession(sessionId);
 			if (!ply)
 				return;
 
-			if (!result)
+			if (!succeeded)
 			{
 				ply->PrintMessage("Failed to spawn spaceship \"" + spaceshipName + "\", please contact an admin");
 				return;
 			}
 
-			if (result.GetRowCount() == 0)
+			if (!spaceship)
 			{
 				ply->PrintMessage("You have no spaceship named \"" + spaceshipName + "\"");
 				return;
 			}
 
-			Nz::Int32 spaceshipId = std::get<Nz::Int32>(result.GetValue(0));
-			std::string code = std::get<std::string>(result.GetValue(1));
-			Nz::Int32 spaceshipHullId = std::get<Nz::Int32>(result.GetValue(2));
-
-			app->GetGlobalDatabase().ExecuteQuery("FindSpaceshipModulesBySpaceshipId", { spaceshipId }, [app, ply, spaceshipHullId, spaceshipCount, shipName = std::move(spaceshipName), spaceshipCode = std::move(code)](DatabaseResult& result)
+			for (std::size_t i = 0; i < spaceshipCount; ++i)
 			{
-				if (!result)
-					std::cerr << "Find spaceship modules failed: " << result.GetLastErrorMessage() << std::endl;
-
-				if (!ply)
-					return;
-
-				if (!result)
+				const Ndk::EntityHandle& playerBot = ply->InstantiateBot(spaceshipName, spaceship->hullId, float(i) * Nz::Vector3f::Right() * 10.f);
+				ScriptComponent& botScript = playerBot->AddComponent<ScriptComponent>();
+				if (!botScript.Initialize(app, spaceship->moduleIds))
 				{
-					ply->PrintMessage("Failed to retrieve spaceship modules, please contact an administrator");
+					ply->PrintMessage("Failed to initialize bot #" + std::to_string(i) + ", please contact an administrator");
 					return;
 				}
 
-				std::size_t moduleCount = result.GetRowCount();
-
-				std::vector<std::size_t> moduleIds(moduleCount);
-				try
-				{
-					for (std::size_t i = 0; i < moduleCount; ++i)
-						moduleIds[i] = static_cast<std::size_t>(std::get<Nz::Int32>(result.GetValue(0, i)));
-				}
-				catch (const std::exception& e)
-				{
-					std::cerr << "Failed to retrieve spaceship modules: " << e.what() << std::endl;
-
-					ply->PrintMessage("Failed to retrieve spaceship modules, please contact an administrator");
-					return;
-				}
-
-				for (std::size_t i = 0; i < spaceshipCount; ++i)
-				{
-					const Ndk::EntityHandle& playerBot = ply->InstantiateBot(shipName, spaceshipHullId, float(i) * Nz::Vector3f::Right() * 10.f);
-					ScriptComponent& botScript = playerBot->AddComponent<ScriptComponent>();
-					if (!botScript.Initialize(app, moduleIds))
-					{
-						ply->PrintMessage("Failed to initialize bot #" + std::to_string(i) + ", please contact an administrator");
-						return;
-					}
-
-					Nz::String lastError;
-					if (!botScript.Execute(spaceshipCode, &lastError))
-						ply->PrintMessage("Failed to execute script for bot #" + std::to_string(i) + ": " + lastError.ToStdString());
-				}
+				Nz::String lastError;
+				if (!botScript.Execute(spaceship->script, &lastError))
+					ply->PrintMessage("Failed to execute script for bot #" + std::to_string(i) + ": " + lastError.ToStdString());
+			}
 
-				ply->PrintMessage("Bot(s) loaded with success");
-			});
+			ply->PrintMessage("Bot(s) loaded with success");
 		});
 
 		return true;
@@ -236,6 +228,16 @@ namespace ewn
 		return true;
 	}
 
+	bool ServerChatCommandStore::HandleTickStats(ServerApplication* app, Player* player)
+	{
+		if (player->GetPermissionLevel() < 20)
+			return false;
+
+		player->PrintMessage("Ticks: " + std::to_string(app->GetTickCount()) + " run, " + std::to_string(app->GetTickOverrunCount()) + " overrun(s), " + std::to_string(app->GetSkippedTickCount()) + " skipped");
+
+		return true;
+	}
+
 	bool ServerChatCommandStore::HandleUpdatePermission(ServerApplication* app, Player* player, Player* target, Nz::UInt16 permissionLevel)
 	{
 		if (permissionLevel >= player->GetPermissionLevel())
@@ -0,0 +1,275 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/SpaceshipCache.hpp>
+#include <Nazara/Core/CallOnExit.hpp>
+#include <Server/Database/Database.hpp>
+#include <cassert>
+#include <cctype>
+#include <iostream>
+
+namespace ewn
+{
+	void SpaceshipCache::Evict(Nz::Int32 ownerId)
+	{
+		auto it = m_accounts.find(ownerId);
+		if (it == m_accounts.end())
+			return;
+
+		// Keep the entry until running queries are done with it, they won't store their rows and the last one erases it
+		AccountEntry& account = it->second;
+		if (account.pendingQueryCount > 0)
+		{
+			account.fleets.clear();
+			account.spaceships.clear();
+			account.evicted = true;
+		}
+		else
+			m_accounts.erase(it);
+	}
+
+	void SpaceshipCache::FindFleet(Nz::Int32 ownerId, const std::string& fleetName, FleetCallback callback)
+	{
+		std::string key = ToKey(fleetName);
+
+		AccountEntry& account = m_accounts[ownerId];
+		if (auto it = account.fleets.find(key); it != account.fleets.end())
+		{
+			m_hitCount++;
+			callback(true, &it->second);
+			return;
+		}
+
+		m_missCount++;
+
+		// Fleet, spaceships and their modules are retrieved at once
+		account.pendingQueryCount++;
+		m_database.ExecuteQuery("FindFleetSpaceshipsByOwnerIdAndName", { ownerId, fleetName }, [this, ownerId, key = std::move(key), version = account.version, cb = std::move(callback)](DatabaseResult& result)
+		{
+			Nz::CallOnExit releaseAccount([&]() { ReleaseAccount(ownerId); });
+
+			if (!result)
+			{
+				std::cerr << "FindFleetSpaceshipsByOwnerIdAndName failed: " << result.GetLastErrorMessage() << std::endl;
+				cb(false, nullptr);
+				return;
+			}
+
+			std::size_t rowCount = result.GetRowCount();
+			if (rowCount == 0)
+			{
+				cb(true, nullptr);
+				return;
+			}
+
+			Fleet fleet;
+
+			// An existing fleet without spaceship comes back as a single row without spaceship (because of the left join)
+			if (!result.IsNull(0, 0))
+			{
+				fleet.spaceships.resize(rowCount);
+				try
+				{
+					for (std::size_t i = 0; i < rowCount; ++i)
+					{
+						Fleet::Entry& fleetSpaceship = fleet.spaceships[i];
+						fleetSpaceship.count = std::get<Nz::Int16>(result.GetValue(1, i));
+						fleetSpaceship.script = std::get<std::string>(result.GetValue(2, i));
+						fleetSpaceship.hullId = std::get<Nz::Int32>(result.GetValue(3, i));
+
+						nlohmann::json moduleIds = std::get<nlohmann::json>(result.GetValue(4, i));
+						for (const auto& moduleId : moduleIds)
+							fleetSpaceship.moduleIds.push_back(moduleId.get<std::size_t>());
+					}
+				}
+				catch (const std::exception& e)
+				{
+					std::cerr << "Failed to retrieve fleet spaceships: " << e.what() << std::endl;
+					cb(false, nullptr);
+					return;
+				}
+			}
+
+			// Fleet rows embed spaceship data, they're dropped along with spaceships on invalidation
+			AccountEntry& account = m_accounts[ownerId];
+			if (account.evicted || account.version != version)
+			{
+				cb(true, &fleet);
+				return;
+			}
+
+			auto it = account.fleets.insert_or_assign(key, std::move(fleet)).first;
+			cb(true, &it->second);
+		});
+	}
+
+	void SpaceshipCache::FindSpaceship(Nz::Int32 ownerId, const std::string& spaceshipName, Callback callback)
+	{
+		std::string key = ToKey(spaceshipName);
+
+		AccountEntry& account = m_accounts[ownerId];
+		if (auto it = account.spaceships.find(key); it != account.spaceships.end())
+		{
+			m_hitCount++;
+			callback(true, &it->second);
+			return;
+		}
+
+		m_missCount++;
+
+		account.pendingQueryCount++;
+		m_database.ExecuteQuery("FindSpaceshipWithModulesByOwnerIdAndName", { ownerId, spaceshipName }, [this, ownerId, key = std::move(key), version = account.version, cb = std::move(callback)](DatabaseResult& result) mutable
+		{
+			Nz::CallOnExit releaseAccount([&]() { ReleaseAccount(ownerId); });
+
+			if (!result)
+			{
+				std::cerr << "FindSpaceshipWithModulesByOwnerIdAndName failed: " << result.GetLastErrorMessage() << std::endl;
+				cb(false, nullptr);
+				return;
+			}
+
+			if (result.GetRowCount() == 0)
+			{
+				cb(true, nullptr);
+				return;
+			}
+
+			Spaceship spaceship;
+			if (!ParseSpaceship(result, spaceship))
+			{
+				cb(false, nullptr);
+				return;
+			}
+
+			StoreSpaceship(ownerId, version, std::move(key), std::move(spaceship), cb);
+		});
+	}
+
+	void SpaceshipCache::FindSpaceship(Nz::Int32 ownerId, Nz::Int32 spaceshipId, Callback callback)
+	{
+		// Accounts only own a handful of spaceships, a linear search is enough
+		AccountEntry& account = m_accounts[ownerId];
+		for (const auto& pair : account.spaceships)
+		{
+			if (pair.second.id == spaceshipId)
+			{
+				m_hitCount++;
+				callback(true, &pair.second);
+				return;
+			}
+		}
+
+		m_missCount++;
+
+		account.pendingQueryCount++;
+		m_database.ExecuteQuery("FindSpaceshipWithModulesByIdAndOwnerId", { spaceshipId, ownerId }, [this, ownerId, version = account.version, cb = std::move(callback)](DatabaseResult& result)
+		{
+			Nz::CallOnExit releaseAccount([&]() { ReleaseAccount(ownerId); });
+
+			if (!result)
+			{
+				std::cerr << "FindSpaceshipWithModulesByIdAndOwnerId failed: " << result.GetLastErrorMessage() << std::endl;
+				cb(false, nullptr);
+				return;
+			}
+
+			if (result.GetRowCount() == 0)
+			{
+				cb(true, nullptr);
+				return;
+			}
+
+			Spaceship spaceship;
+			if (!ParseSpaceship(result, spaceship))
+			{
+				cb(false, nullptr);
+				return;
+			}
+
+			std::string key;
+			try
+			{
+				key = ToKey(std::get<std::string>(result.GetValue(4)));
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Failed to retrieve spaceship name: " << e.what() << std::endl;
+				cb(false, nullptr);
+				return;
+			}
+
+			StoreSpaceship(ownerId, version, std::move(key), std::move(spaceship), cb);
+		});
+	}
+
+	void SpaceshipCache::Invalidate(Nz::Int32 ownerId)
+	{
+		// Without entry, nothing is cached nor running for this account
+		auto it = m_accounts.find(ownerId);
+		if (it == m_accounts.end())
+			return;
+
+		AccountEntry& account = it->second;
+		account.fleets.clear();
+		account.spaceships.clear();
+		account.version++;
+	}
+
+	bool SpaceshipCache::ParseSpaceship(DatabaseResult& result, Spaceship& spaceship)
+	{
+		try
+		{
+			spaceship.id = std::get<Nz::Int32>(result.GetValue(0));
+			spaceship.script = std::get<std::string>(result.GetValue(1));
+			spaceship.hullId = std::get<Nz::Int32>(result.GetValue(2));
+
+			nlohmann::json moduleIds = std::get<nlohmann::json>(result.GetValue(3));
+			for (const auto& moduleId : moduleIds)
+				spaceship.moduleIds.push_back(moduleId.get<std::size_t>());
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Failed to retrieve spaceship: " << e.what() << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	void SpaceshipCache::ReleaseAccount(Nz::Int32 ownerId)
+	{
+		auto it = m_accounts.find(ownerId);
+		assert(it != m_accounts.end());
+
+		AccountEntry& account = it->second;
+		assert(account.pendingQueryCount > 0);
+		if (--account.pendingQueryCount == 0 && account.evicted)
+			m_accounts.erase(it);
+	}
+
+	void SpaceshipCache::StoreSpaceship(Nz::Int32 ownerId, Nz::UInt64 version, std::string key, Spaceship spaceship, const Callback& callback)
+	{
+		// Don't store the row if the spaceship was modified while the query was running, or its owner left
+		AccountEntry& account = m_accounts[ownerId];
+		if (account.evicted || account.version != version)
+		{
+			callback(true, &spaceship);
+			return;
+		}
+
+		auto it = account.spaceships.insert_or_assign(std::move(key), std::move(spaceship)).first;
+		callback(true, &it->second);
+	}
+
+	std::string SpaceshipCache::ToKey(const std::string& name)
+	{
+		// Matches LOWER() for ASCII names, other names will only miss more often
+		std::string key = name;
+		for (char& c : key)
+			c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+		return key;
+	}
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_SPACESHIPCACHE_HPP
+#define EREWHON_SERVER_SPACESHIPCACHE_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ewn
+{
+	class Database;
+	class DatabaseResult;
+
+	// Read-through cache of spaceship and fleet rows per connected account, must only be used from the main thread
+	class SpaceshipCache
+	{
+		public:
+			struct Fleet;
+			struct Spaceship;
+
+			using Callback = std::function<void(bool succeeded, const Spaceship* spaceship)>;
+			using FleetCallback = std::function<void(bool succeeded, const Fleet* fleet)>;
+
+			inline SpaceshipCache(Database& database);
+			SpaceshipCache(const SpaceshipCache&) = delete;
+			SpaceshipCache(SpaceshipCache&&) = delete;
+			~SpaceshipCache() = default;
+
+			void Evict(Nz::Int32 ownerId);
+
+			void FindFleet(Nz::Int32 ownerId, const std::string& fleetName, FleetCallback callback);
+			void FindSpaceship(Nz::Int32 ownerId, const std::string& spaceshipName, Callback callback);
+			void FindSpaceship(Nz::Int32 ownerId, Nz::Int32 spaceshipId, Callback callback);
+
+			inline Nz::UInt64 GetHitCount() const;
+			inline Nz::UInt64 GetMissCount() const;
+
+			void Invalidate(Nz::Int32 ownerId);
+
+			SpaceshipCache& operator=(const SpaceshipCache&) = delete;
+			SpaceshipCache& operator=(SpaceshipCache&&) = delete;
+
+			struct Spaceship
+			{
+				std::string script;
+				std::vector<std::size_t> moduleIds;
+				Nz::Int32 hullId;
+				Nz::Int32 id;
+			};
+
+			struct Fleet
+			{
+				struct Entry
+				{
+					std::string script;
+					std::vector<std::size_t> moduleIds;
+					Nz::Int16 count;
+					Nz::Int32 hullId;
+				};
+
+				std::vector<Entry> spaceships;
+			};
+
+		private:
+			void ReleaseAccount(Nz::Int32 ownerId);
+			void StoreSpaceship(Nz::Int32 ownerId, Nz::UInt64 version, std::string key, Spaceship spaceship, const Callback& callback);
+
+			static bool ParseSpaceship(DatabaseResult& result, Spaceship& spaceship);
+			static std::string ToKey(const std::string& name);
+
+			struct AccountEntry
+			{
+				std::unordered_map<std::string, Fleet> fleets;
+				std::unordered_map<std::string, Spaceship> spaceships;
+				std::size_t pendingQueryCount = 0;
+				Nz::UInt64 version = 0;
+				bool evicted = false;
+			};
+
+			std::unordered_map<Nz::Int32, AccountEntry> m_accounts;
+			Database& m_database;
+			Nz::UInt64 m_hitCount;
+			Nz::UInt64 m_missCount;
+	};
+}
+
+#include <Server/SpaceshipCache.inl>
+
+#endif // EREWHON_SERVER_SPACESHIPCACHE_HPP
@@ -0,0 +1,25 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/SpaceshipCache.hpp>
+
+namespace ewn
+{
+	inline SpaceshipCache::SpaceshipCache(Database& database) :
+	m_database(database),
+	m_hitCount(0),
+	m_missCount(0)
+	{
+	}
+
+	inline Nz::UInt64 SpaceshipCache::GetHitCount() const
+	{
+		return m_hitCount;
+	}
+
+	inline Nz::UInt64 SpaceshipCache::GetMissCount() const
+	{
+		return m_missCount;
+	}
+}
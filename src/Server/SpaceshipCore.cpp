@@ -9,6 +9,7 @@
 #include <Server/Components/SignatureComponent.hpp>
 #include <cassert>
 #include <iostream>
+#include <stdexcept>
 
 namespace ewn
 {
@@ -31,6 +32,14 @@ namespace ewn
 		modulePtr->Initialize(m_spaceship);
 	}
 
+	void SpaceshipCore::ExecuteActions()
+	{
+		for (const ActionFunction& action : m_pendingActions)
+			action();
+
+		m_pendingActions.clear();
+	}
+
 	LuaVec3 SpaceshipCore::GetAngularVelocity() const
 	{
 		auto& nodeComponent = m_spaceship->GetComponent<Ndk::PhysicsComponent3D>();
@@ -67,8 +76,68 @@ namespace ewn
 		return signatureComponent.GetSignature();
 	}
 
+	std::optional<std::pair<SpaceshipCore::CallbackId, SpaceshipCore::CallbackArgFunction>> SpaceshipCore::PopCallback()
+	{
+		if (m_callbacks.empty())
+			return {};
+
+		Nz::UInt64 now = ServerApplication::GetAppTime();
+		if (m_callbacks.front().triggerTime >= now)
+			return {};
+
+		SwapCallbacks(0, m_callbacks.size() - 1);
+
+		Callback callback = std::move(m_callbacks.back());
+		m_callbacks.pop_back();
+
+		if (!m_callbacks.empty())
+			MoveCallbackDown(0);
+
+		if (callback.unique)
+			m_uniqueCallbackIndices[callback.callbackId] = InvalidCallbackIndex;
+
+		return std::make_pair(callback.callbackId, std::move(callback.argFunc));
+	}
+
+	void SpaceshipCore::PushCallback(Nz::UInt64 triggerTime, CallbackId callbackId, CallbackArgFunction argFunc, bool unique)
+	{
+		if (unique)
+		{
+			if (callbackId >= m_uniqueCallbackIndices.size())
+				m_uniqueCallbackIndices.resize(callbackId + 1, InvalidCallbackIndex);
+
+			// If callback is already waiting, reschedule it in place
+			std::size_t callbackIndex = m_uniqueCallbackIndices[callbackId];
+			if (callbackIndex != InvalidCallbackIndex)
+			{
+				Callback& callback = m_callbacks[callbackIndex];
+				callback.argFunc = std::move(argFunc);
+				callback.sequence = m_nextCallbackSequence++;
+				callback.triggerTime = triggerTime;
+
+				MoveCallbackUp(callbackIndex);
+				MoveCallbackDown(m_uniqueCallbackIndices[callbackId]);
+				return;
+			}
+
+			m_uniqueCallbackIndices[callbackId] = m_callbacks.size();
+		}
+
+		Callback& callback = m_callbacks.emplace_back();
+		callback.argFunc = std::move(argFunc);
+		callback.callbackId = callbackId;
+		callback.sequence = m_nextCallbackSequence++;
+		callback.triggerTime = triggerTime;
+		callback.unique = unique;
+
+		MoveCallbackUp(m_callbacks.size() - 1);
+	}
+
 	void SpaceshipCore::Register(Nz::LuaState& lua)
 	{
+		// Bindings are lazily built and shared by every arena, which may be updated concurrently
+		std::lock_guard<std::mutex> lock(s_bindingMutex);
+
 		if (!s_binding)
 		{
 			s_binding.emplace("Core");
@@ -120,5 +189,86 @@ namespace ewn
 			modulePtr->Run(elapsedTime);
 	}
 
+	const std::string& SpaceshipCore::GetCallbackName(CallbackId callbackId)
+	{
+		// Lock-free, ids are only handed out once their name is published
+		assert(callbackId < s_callbackCount.load(std::memory_order_acquire));
+		return s_callbackNames[callbackId];
+	}
+
+	SpaceshipCore::CallbackId SpaceshipCore::InternCallback(const std::string& callbackName)
+	{
+		// Cores from every arena share callback ids
+		std::lock_guard<std::mutex> lock(s_callbackMutex);
+
+		auto it = s_callbackIds.find(callbackName);
+		if (it == s_callbackIds.end())
+		{
+			CallbackId callbackId = s_callbackCount.load(std::memory_order_relaxed);
+			if (callbackId >= MaxCallbackCount)
+				throw std::runtime_error("Too many spaceship callbacks");
+
+			s_callbackNames[callbackId] = callbackName;
+			s_callbackCount.store(callbackId + 1, std::memory_order_release);
+
+			it = s_callbackIds.emplace(callbackName, callbackId).first;
+		}
+
+		return it->second;
+	}
+
+	void SpaceshipCore::MoveCallbackDown(std::size_t index)
+	{
+		std::size_t callbackCount = m_callbacks.size();
+		for (;;)
+		{
+			std::size_t firstChild = index * 2 + 1;
+			if (firstChild >= callbackCount)
+				break;
+
+			std::size_t bestChild = firstChild;
+			if (firstChild + 1 < callbackCount && IsCallbackBefore(firstChild + 1, firstChild))
+				bestChild = firstChild + 1;
+
+			if (!IsCallbackBefore(bestChild, index))
+				break;
+
+			SwapCallbacks(index, bestChild);
+			index = bestChild;
+		}
+	}
+
+	void SpaceshipCore::MoveCallbackUp(std::size_t index)
+	{
+		while (index > 0)
+		{
+			std::size_t parent = (index - 1) / 2;
+			if (!IsCallbackBefore(index, parent))
+				break;
+
+			SwapCallbacks(index, parent);
+			index = parent;
+		}
+	}
+
+	void SpaceshipCore::SwapCallbacks(std::size_t lhs, std::size_t rhs)
+	{
+		if (lhs == rhs)
+			return;
+
+		std::swap(m_callbacks[lhs], m_callbacks[rhs]);
+
+		if (m_callbacks[lhs].unique)
+			m_uniqueCallbackIndices[m_callbacks[lhs].callbackId] = lhs;
+
+		if (m_callbacks[rhs].unique)
+			m_uniqueCallbackIndices[m_callbacks[rhs].callbackId] = rhs;
+	}
+
+	std::mutex SpaceshipCore::s_bindingMutex;
+	std::array<std::string, SpaceshipCore::MaxCallbackCount> SpaceshipCore::s_callbackNames;
+	std::atomic<SpaceshipCore::CallbackId> SpaceshipCore::s_callbackCount(0);
+	std::mutex SpaceshipCore::s_callbackMutex;
+	std::unordered_map<std::string, SpaceshipCore::CallbackId> SpaceshipCore::s_callbackIds;
 	std::optional<Nz::LuaClass<SpaceshipCoreHandle>> SpaceshipCore::s_binding;
 }
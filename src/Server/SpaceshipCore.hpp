@@ -13,7 +13,11 @@
 #include <NDK/Entity.hpp>
 #include <Shared/Enums.hpp>
 #include <Server/Scripting/LuaMathTypes.hpp>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <limits>
+#include <mutex>
 #include <optional>
 #include <unordered_map>
 #include <vector>
@@ -28,21 +32,28 @@ namespace ewn
 	class SpaceshipCore : public Nz::HandledObject<SpaceshipCore>
 	{
 		public:
+			using ActionFunction = std::function<void()>;
 			using CallbackArgFunction = std::function<int(Nz::LuaState& state)>;
+			using CallbackId = std::size_t;
 
 			inline SpaceshipCore(const Ndk::EntityHandle& spaceship);
 			SpaceshipCore(const SpaceshipCore&) = delete;
 			~SpaceshipCore();
 
 			void AddModule(std::shared_ptr<SpaceshipModule> newModule);
+
+			void ExecuteActions();
 			template<typename T> T* GetModule(ModuleType type);
 
 			void Register(Nz::LuaState& lua);
 			void Run(float elapsedTime);
 
-			inline void PushCallback(std::string callbackName, CallbackArgFunction argFunc = nullptr, bool unique = true);
-			inline void PushCallback(Nz::UInt64 triggerTime, std::string callbackName, CallbackArgFunction argFunc = nullptr, bool unique = true);
-			inline std::optional<std::pair<std::string, CallbackArgFunction>> PopCallback();
+			inline void PushAction(ActionFunction action);
+			inline void PushCallback(CallbackId callbackId, CallbackArgFunction argFunc = nullptr, bool unique = true);
+			inline void PushCallback(const std::string& callbackName, CallbackArgFunction argFunc = nullptr, bool unique = true);
+			void PushCallback(Nz::UInt64 triggerTime, CallbackId callbackId, CallbackArgFunction argFunc = nullptr, bool unique = true);
+			inline void PushCallback(Nz::UInt64 triggerTime, const std::string& callbackName, CallbackArgFunction argFunc = nullptr, bool unique = true);
+			std::optional<std::pair<CallbackId, CallbackArgFunction>> PopCallback();
 
 			// Lua API
 			LuaVec3 GetAngularVelocity() const;
@@ -54,20 +65,40 @@ namespace ewn
 
 			SpaceshipCore& operator=(const SpaceshipCore&) = delete;
 
+			static const std::string& GetCallbackName(CallbackId callbackId);
+			static CallbackId InternCallback(const std::string& callbackName);
+
 		private:
 			struct Callback
 			{
+				Nz::UInt64 sequence;
 				Nz::UInt64 triggerTime;
-				std::string callbackName;
 				CallbackArgFunction argFunc;
+				CallbackId callbackId;
+				bool unique;
 			};
 
-			std::unordered_map<std::string, bool> m_pushedCallbacks;
+			inline bool IsCallbackBefore(std::size_t lhs, std::size_t rhs) const;
+			void MoveCallbackDown(std::size_t index);
+			void MoveCallbackUp(std::size_t index);
+			void SwapCallbacks(std::size_t lhs, std::size_t rhs);
+
+			static constexpr std::size_t InvalidCallbackIndex = std::numeric_limits<std::size_t>::max();
+			static constexpr std::size_t MaxCallbackCount = 64;
+
+			std::vector<std::size_t> m_uniqueCallbackIndices; //< Indexed by callback id
 			std::vector<std::shared_ptr<SpaceshipModule>> m_modules;
 			std::vector<std::shared_ptr<SpaceshipModule>> m_runnableModules;
-			std::vector<Callback> m_callbacks;
+			std::vector<ActionFunction> m_pendingActions;
+			std::vector<Callback> m_callbacks; //< Binary min-heap on trigger time
 			Ndk::EntityHandle m_spaceship;
+			Nz::UInt64 m_nextCallbackSequence;
 
+			static std::mutex s_bindingMutex;
+			static std::array<std::string, MaxCallbackCount> s_callbackNames; //< Slots are never written again once published by s_callbackCount
+			static std::atomic<CallbackId> s_callbackCount;
+			static std::mutex s_callbackMutex;
+			static std::unordered_map<std::string, CallbackId> s_callbackIds;
 			static std::optional<Nz::LuaClass<SpaceshipCoreHandle>> s_binding;
 	};
 }
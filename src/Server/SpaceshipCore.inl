@@ -9,7 +9,8 @@
 namespace ewn
 {
 	inline SpaceshipCore::SpaceshipCore(const Ndk::EntityHandle& spaceship) :
-	m_spaceship(spaceship)
+	m_spaceship(spaceship),
+	m_nextCallbackSequence(0)
 	{
 	}
 
@@ -26,75 +27,36 @@ namespace ewn
 		return static_cast<T*>(spaceshipModule);
 	}
 
-	inline void SpaceshipCore::PushCallback(std::string callbackName, CallbackArgFunction argFunc, bool unique)
+	inline void SpaceshipCore::PushAction(ActionFunction action)
 	{
-		PushCallback(ServerApplication::GetAppTime(), std::move(callbackName), std::move(argFunc), unique);
+		m_pendingActions.emplace_back(std::move(action));
 	}
 
-	inline void SpaceshipCore::PushCallback(Nz::UInt64 triggerTime, std::string callbackName, CallbackArgFunction argFunc, bool unique)
+	inline void SpaceshipCore::PushCallback(CallbackId callbackId, CallbackArgFunction argFunc, bool unique)
 	{
-		auto SortCallbacks = [](const Callback& lhs, const Callback& rhs)
-		{
-			return lhs.triggerTime > rhs.triggerTime;
-		};
-
-		// Check if callback is already in the waiting queue
-		if (unique)
-		{
-			auto it = m_pushedCallbacks.find(callbackName);
-			if (it == m_pushedCallbacks.end())
-				it = m_pushedCallbacks.emplace(callbackName, true).first;
-			else if (it->second)
-			{
-				// If callback is already present, update its trigger time and resort callback
-				for (auto callbackIt = m_callbacks.begin(); callbackIt != m_callbacks.end(); ++callbackIt)
-				{
-					if (callbackIt->callbackName == callbackName)
-					{
-						callbackIt->argFunc = std::move(argFunc);
-						callbackIt->triggerTime = triggerTime;
-						std::sort(m_callbacks.begin(), m_callbacks.end(), SortCallbacks);
-						return;
-					}
-				}
-			}
-			else
-				it->second = true;
-		}
-
-		// Insert a new callback in the queue
-		Callback callback;
-		callback.argFunc = std::move(argFunc);
-		callback.callbackName = std::move(callbackName);
-		callback.triggerTime = triggerTime;
-
-		auto callbackIt = std::upper_bound(m_callbacks.begin(), m_callbacks.end(), callback, SortCallbacks);
-
-		m_callbacks.emplace(callbackIt, std::move(callback));
+		PushCallback(ServerApplication::GetAppTime(), callbackId, std::move(argFunc), unique);
 	}
 
-	inline std::optional<std::pair<std::string, SpaceshipCore::CallbackArgFunction>> SpaceshipCore::PopCallback()
+	inline void SpaceshipCore::PushCallback(const std::string& callbackName, CallbackArgFunction argFunc, bool unique)
 	{
-		if (m_callbacks.empty())
-			return {};
-
-		Nz::UInt64 now = ServerApplication::GetAppTime();
-		if (m_callbacks.back().triggerTime >= now)
-			return {};
+		PushCallback(ServerApplication::GetAppTime(), InternCallback(callbackName), std::move(argFunc), unique);
+	}
 
-		Callback callback = std::move(m_callbacks.back());
-		m_callbacks.pop_back();
+	inline void SpaceshipCore::PushCallback(Nz::UInt64 triggerTime, const std::string& callbackName, CallbackArgFunction argFunc, bool unique)
+	{
+		PushCallback(triggerTime, InternCallback(callbackName), std::move(argFunc), unique);
+	}
 
-		auto it = m_pushedCallbacks.find(callback.callbackName);
-		if (it != m_pushedCallbacks.end())
-		{
-			assert(it->second);
-			it->second = false;
-		}
+	inline bool SpaceshipCore::IsCallbackBefore(std::size_t lhs, std::size_t rhs) const
+	{
+		const Callback& lhsCallback = m_callbacks[lhs];
+		const Callback& rhsCallback = m_callbacks[rhs];
 
-		//std::cout << "Executing " << callback.callbackName << " (late by " << (now - callback.triggerTime) << "ms)" << std::endl;
+		// Callbacks sharing the same trigger time are fired in push order
+		if (lhsCallback.triggerTime != rhsCallback.triggerTime)
+			return lhsCallback.triggerTime < rhsCallback.triggerTime;
 
-		return std::make_pair(callback.callbackName, std::move(callback.argFunc));
+		return lhsCallback.sequence < rhsCallback.sequence;
 	}
 }
 
@@ -44,6 +44,7 @@ namespace ewn
 			inline SpaceshipCore* GetCore();
 			inline const Ndk::EntityHandle& GetSpaceship();
 			inline const Ndk::EntityHandle& GetSpaceship() const;
+			template<typename F> void PushAction(F&& action);
 			template<typename... Args> void PushCallback(Args&&... args);
 
 			virtual void RegisterModule(Nz::LuaClass<SpaceshipModule>& parentBinding, Nz::LuaState& lua) = 0;
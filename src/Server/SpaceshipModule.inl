@@ -55,6 +55,12 @@ namespace ewn
 		return m_spaceship;
 	}
 
+	template<typename F>
+	void SpaceshipModule::PushAction(F&& action)
+	{
+		m_core->PushAction(std::forward<F>(action));
+	}
+
 	template<typename... Args>
 	void SpaceshipModule::PushCallback(Args&&... args)
 	{
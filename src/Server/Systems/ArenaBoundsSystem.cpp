@@ -0,0 +1,54 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Systems/ArenaBoundsSystem.hpp>
+#include <Nazara/Core/Algorithm.hpp>
+#include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Shared/Protocol/QuantizedTypes.hpp>
+#include <Server/Components/ProjectileComponent.hpp>
+#include <cmath>
+
+namespace ewn
+{
+	ArenaBoundsSystem::ArenaBoundsSystem()
+	{
+		Requires<Ndk::PhysicsComponent3D>();
+		SetUpdateOrder(50); //< After physics, before broadcasting
+	}
+
+	void ArenaBoundsSystem::OnUpdate(float /*elapsedTime*/)
+	{
+		for (const Ndk::EntityHandle& entity : GetEntities())
+		{
+			auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+			Nz::Vector3f position = entityPhys.GetPosition();
+			if (std::abs(position.x) <= ArenaExtent && std::abs(position.y) <= ArenaExtent && std::abs(position.z) <= ArenaExtent)
+				continue;
+
+			if (entity->HasComponent<ProjectileComponent>())
+			{
+				entity->Kill();
+				continue;
+			}
+
+			// Stop the entity at the arena border, it can still move along it or back inside
+			Nz::Vector3f velocity = entityPhys.GetLinearVelocity();
+			for (unsigned int i = 0; i < 3; ++i)
+			{
+				if (std::abs(position[i]) > ArenaExtent)
+				{
+					position[i] = Nz::Clamp(position[i], -ArenaExtent, ArenaExtent);
+					if (velocity[i] * position[i] > 0.f)
+						velocity[i] = 0.f;
+				}
+			}
+
+			entityPhys.SetPosition(position);
+			entityPhys.SetLinearVelocity(velocity);
+		}
+	}
+
+	Ndk::SystemIndex ArenaBoundsSystem::systemIndex;
+}
@@ -0,0 +1,30 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_ARENABOUNDSSYSTEM_HPP
+#define EREWHON_SERVER_ARENABOUNDSSYSTEM_HPP
+
+#include <NDK/System.hpp>
+
+namespace ewn
+{
+	// Keeps physical entities inside the arena extent (projectiles leaving it are destroyed)
+	class ArenaBoundsSystem : public Ndk::System<ArenaBoundsSystem>
+	{
+		public:
+			ArenaBoundsSystem();
+			~ArenaBoundsSystem() = default;
+
+			static Ndk::SystemIndex systemIndex;
+
+		private:
+			void OnUpdate(float elapsedTime) override;
+	};
+}
+
+#include <Server/Systems/ArenaBoundsSystem.inl>
+
+#endif // EREWHON_SERVER_ARENABOUNDSSYSTEM_HPP
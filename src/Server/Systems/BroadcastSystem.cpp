@@ -3,147 +3,442 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Systems/BroadcastSystem.hpp>
-#include <Server/Components/SynchronizedComponent.hpp>
 #include <Nazara/Core/MemoryHelper.hpp>
 #include <Nazara/Physics3D/Collider3D.hpp>
 #include <NDK/Components/CollisionComponent3D.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Server/Player.hpp>
 #include <Server/ServerApplication.hpp>
+#include <Server/Components/ScriptComponent.hpp>
+#include <Server/Components/SynchronizedComponent.hpp>
+#include <Server/Modules/RadarModule.hpp>
 #include <Server/Systems/InputSystem.hpp>
+#include <algorithm>
 #include <cassert>
+#include <limits>
 
 namespace ewn
 {
-	BroadcastSystem::BroadcastSystem() :
-	m_snapshotId(0)
+	BroadcastSystem::BroadcastSystem(ServerApplication* app) :
+	m_snapshotId(0),
+	m_app(app),
+	m_interestRadius(1000.f)
 	{
 		Requires<Ndk::NodeComponent, SynchronizedComponent>();
 		SetMaximumUpdateRate(30.f);
 		SetUpdateOrder(100);
 	}
 
-	void BroadcastSystem::OnEntityRemoved(Ndk::Entity* entity)
+	void BroadcastSystem::AddPlayer(Player* player)
 	{
-		m_movingEntities.Remove(entity);
-
-		Packets::DeleteEntity deletePacket;
-		deletePacket.id = entity->GetId();
+		PlayerData& playerData = m_players.emplace_back();
+		playerData.player = player;
+		playerData.lastViewPosition = Nz::Vector3f::Zero();
 
-		BroadcastEntityDestruction(this, deletePacket);
+		// Static entities are always relevant, but are queued to spread their creation over the next updates
+		// Moving ones will be streamed on next update depending on their relevance
+		for (const Ndk::EntityHandle& entity : GetEntities())
+		{
+			if (!m_movingEntities.Has(entity))
+			{
+				playerData.pendingEntities.UnboundedSet(entity->GetId());
+				playerData.pendingQueue.push_back(entity);
+			}
+		}
 	}
 
-	void BroadcastSystem::OnEntityValidation(Ndk::Entity* entity, bool justAdded)
+	void BroadcastSystem::BuildCreateEntity(Ndk::Entity* entity, Packets::CreateEntity& createPacket)
 	{
 		auto& nodeComponent = entity->GetComponent<Ndk::NodeComponent>();
 		auto& syncComponent = entity->GetComponent<SynchronizedComponent>();
 
+		createPacket.prefabId = Nz::UInt32(syncComponent.GetPrefabId());
+		createPacket.entityId = entity->GetId();
+		createPacket.position = nodeComponent.GetPosition();
+		createPacket.rotation = nodeComponent.GetRotation();
+		createPacket.visualName = syncComponent.GetName();
+
 		if (entity->HasComponent<Ndk::PhysicsComponent3D>())
-			m_movingEntities.Insert(entity);
+		{
+			auto& physComponent = entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+			createPacket.angularVelocity = physComponent.GetAngularVelocity();
+			createPacket.linearVelocity = physComponent.GetLinearVelocity();
+		}
 		else
-			m_movingEntities.Remove(entity);
+		{
+			createPacket.angularVelocity = Nz::Vector3f::Zero();
+			createPacket.linearVelocity = Nz::Vector3f::Zero();
+		}
+	}
+
+	void BroadcastSystem::RemovePlayer(Player* player)
+	{
+		auto it = std::find_if(m_players.begin(), m_players.end(), [player](const PlayerData& playerData) { return playerData.player == player; });
+		assert(it != m_players.end());
+
+		m_players.erase(it);
+	}
+
+	void BroadcastSystem::CreateEntity(PlayerData& playerData, Ndk::Entity* entity)
+	{
+		Ndk::EntityId entityId = entity->GetId();
+
+		playerData.pendingEntities.UnboundedReset(entityId);
+		playerData.visibleEntities.UnboundedSet(entityId);
 
-		if (justAdded)
+		if (playerData.priorityAccumulators.size() <= entityId)
+			playerData.priorityAccumulators.resize(entityId + 1);
+
+		// Make sure the client gets a state update for this entity soon
+		playerData.priorityAccumulators[entityId] = entity->GetComponent<SynchronizedComponent>().GetPriority();
+
+		if (m_movingEntities.Has(entity))
 		{
-			Packets::CreateEntity createPacket;
-			BuildCreateEntity(entity, createPacket);
+			// Moving entities change between updates, but players discovering them during the same update share their packet
+			if (m_movingCreatePackets.size() <= entityId)
+				m_movingCreatePackets.resize(entityId + 1);
+
+			NetworkReactor::SharedPacket& createPacket = m_movingCreatePackets[entityId];
+			if (!createPacket)
+			{
+				createPacket = SerializeCreateEntity(entity);
+				m_serializedMovingEntities.push_back(entityId);
+			}
 
-			BroadcastEntityCreation(this, createPacket);
+			BroadcastEntityCreation(this, playerData.player, createPacket);
+			return;
 		}
+
+		// Static entities don't change, their packet is serialized once for every player
+		if (m_staticCreatePackets.size() <= entityId)
+			m_staticCreatePackets.resize(entityId + 1);
+
+		NetworkReactor::SharedPacket& createPacket = m_staticCreatePackets[entityId];
+		if (!createPacket)
+			createPacket = SerializeCreateEntity(entity);
+
+		BroadcastEntityCreation(this, playerData.player, createPacket);
 	}
 
-	void BroadcastSystem::OnUpdate(float /*elapsedTime*/)
+	void BroadcastSystem::CreatePendingEntities(PlayerData& playerData, std::size_t maxCount)
+	{
+		std::size_t createdCount = 0;
+		while (createdCount < maxCount && !playerData.pendingQueue.empty())
+		{
+			Ndk::EntityHandle entity = std::move(playerData.pendingQueue.back());
+			playerData.pendingQueue.pop_back();
+
+			// Entity may have been destroyed, removed from this system or sent through another path since it was queued
+			if (!entity || !playerData.pendingEntities.UnboundedTest(entity->GetId()))
+				continue;
+
+			if (m_movingEntities.Has(entity))
+			{
+				playerData.pendingEntities.UnboundedReset(entity->GetId());
+				continue;
+			}
+
+			CreateEntity(playerData, entity);
+			createdCount++;
+		}
+	}
+
+	void BroadcastSystem::DeleteEntity(PlayerData& playerData, Ndk::Entity* entity)
+	{
+		Ndk::EntityId entityId = entity->GetId();
+
+		playerData.visibleEntities.Reset(entityId);
+
+		// Deletion packets only depend on the entity id, serialize them once
+		if (m_deletePackets.size() <= entityId)
+			m_deletePackets.resize(entityId + 1);
+
+		NetworkReactor::SharedPacket& deletePacket = m_deletePackets[entityId];
+		if (!deletePacket)
+			deletePacket = SerializeDeleteEntity(entityId);
+
+		BroadcastEntityDestruction(this, playerData.player, deletePacket);
+	}
+
+	void BroadcastSystem::FillInterestAreas(PlayerData& playerData)
 	{
-		static constexpr std::size_t HeaderSize = sizeof(Nz::UInt16) + 2 * sizeof(Nz::UInt64) + sizeof(Nz::UInt32);
-		static constexpr std::size_t EntitySize = sizeof(Packets::ArenaState::Entity);
-		static constexpr std::size_t EntityMaxSize = 1300;
-		static constexpr std::size_t MaxEntityPerUpdate = EntityMaxSize / EntitySize;
+		m_interestAreas.clear();
+
+		// Around the controlled spaceship (or where it was last seen, if the player has none)
+		if (const Ndk::EntityHandle& controlledEntity = playerData.player->GetControlledEntity())
+			playerData.lastViewPosition = controlledEntity->GetComponent<Ndk::NodeComponent>().GetPosition();
 
-		// Allocate a temporary array on the stack to sort entities by their priority accumulator
-		m_priorityQueue.clear();
-		m_priorityQueue.reserve(m_movingEntities.size());
+		m_interestAreas.push_back({ playerData.lastViewPosition, m_interestRadius });
 
-		for (const Ndk::EntityHandle& entities : m_movingEntities)
+		// Around player bots, using their radar range
+		for (const Ndk::EntityOwner& bot : playerData.player->GetBots())
 		{
-			auto& entitySync = entities->GetComponent<SynchronizedComponent>();
-			entitySync.AccumulatePriority();
+			if (!bot || bot->GetWorld() != &GetWorld() || !bot->HasComponent<ScriptComponent>())
+				continue;
 
-			Nz::UInt16 priorityAccumulator = entitySync.GetPriorityAccumulator();
-			if (priorityAccumulator == 0)
+			SpaceshipCore* core = bot->GetComponent<ScriptComponent>().GetCore();
+			if (!core)
 				continue;
 
-			auto& priorityData = m_priorityQueue.emplace_back();
-			priorityData.entity = entities;
-			priorityData.priority = priorityAccumulator;
+			if (RadarModule* radar = core->GetModule<RadarModule>(ModuleType::Radar))
+				m_interestAreas.push_back({ bot->GetComponent<Ndk::NodeComponent>().GetPosition(), radar->GetDetectionRadius() });
 		}
+	}
 
-		std::sort(m_priorityQueue.begin(), m_priorityQueue.end(), [](const EntityPriority& lhs, const EntityPriority& rhs)
-		{
-			return lhs.priority > rhs.priority;
-		});
+	void BroadcastSystem::FillRelevantEntities(const PlayerData& playerData)
+	{
+		Ndk::World& world = GetWorld();
 
-		// Fill our packet with at most MaxEntityPerUpdate entities, by priority order
-		m_arenaStatePacket.stateId = m_snapshotId++;
-		m_arenaStatePacket.serverTime = ServerApplication::GetAppTime();
+		m_relevantEntities.Reset();
 
-		std::size_t counter = 0;
+		if (const Ndk::EntityHandle& controlledEntity = playerData.player->GetControlledEntity(); controlledEntity && m_movingEntities.Has(controlledEntity))
+			m_relevantEntities.UnboundedSet(controlledEntity->GetId());
 
-		m_arenaStatePacket.entities.clear();
-		for (const EntityPriority& priority : m_priorityQueue)
-		{
-			if (++counter > MaxEntityPerUpdate)
-				break;
+		// Only look at entities the spatial grid finds around interest areas, instead of every moving entity
+		m_nearbyEntries.clear();
 
-			auto& entityPhys = priority.entity->GetComponent<Ndk::PhysicsComponent3D>();
-			auto& entitySync = priority.entity->GetComponent<SynchronizedComponent>();
+		const SpatialSystem& spatialSystem = world.GetSystem<SpatialSystem>();
+		for (const InterestArea& area : m_interestAreas)
+			spatialSystem.QuerySphere(area.center, area.radius * VisibleMargin, m_nearbyEntries);
 
-			entitySync.ResetPriorityAccumulator();
+		for (const SpatialSystem::Entry& entry : m_nearbyEntries)
+		{
+			if (m_relevantEntities.UnboundedTest(entry.entityId) || !m_movingEntities.Has(entry.entityId))
+				continue;
 
-			Packets::ArenaState::Entity entityData;
-			entityData.id = priority.entity->GetId();
-			entityData.angularVelocity = entityPhys.GetAngularVelocity();
-			entityData.linearVelocity = entityPhys.GetLinearVelocity();
-			entityData.position = entityPhys.GetPosition();
-			entityData.rotation = entityPhys.GetRotation();
+			// Grid positions date back to its last update, check current ones
+			const Ndk::EntityHandle& entity = world.GetEntity(entry.entityId);
+			if (IsRelevant(playerData, entity, playerData.visibleEntities.UnboundedTest(entry.entityId)))
+				m_relevantEntities.UnboundedSet(entry.entityId);
+		}
+	}
+
+	bool BroadcastSystem::IsRelevant(const PlayerData& playerData, Ndk::Entity* entity, bool isVisible) const
+	{
+		if (entity == playerData.player->GetControlledEntity())
+			return true;
 
-			m_arenaStatePacket.entities.emplace_back(std::move(entityData));
+		Nz::Vector3f position = entity->GetComponent<Ndk::NodeComponent>().GetPosition();
+		for (const InterestArea& area : m_interestAreas)
+		{
+			float radius = (isVisible) ? area.radius * VisibleMargin : area.radius;
+			if (position.SquaredDistance(area.center) <= radius * radius)
+				return true;
 		}
 
-		BroadcastStateUpdate(this, m_arenaStatePacket);
+		return false;
 	}
 
-	void BroadcastSystem::BuildCreateEntity(Ndk::Entity* entity, Packets::CreateEntity& createPacket)
+	void BroadcastSystem::OnEntityRemoved(Ndk::Entity* entity)
 	{
-		auto& nodeComponent = entity->GetComponent<Ndk::NodeComponent>();
-		auto& syncComponent = entity->GetComponent<SynchronizedComponent>();
+		Ndk::EntityId entityId = entity->GetId();
 
-		createPacket.prefabId = Nz::UInt32(syncComponent.GetPrefabId());
-		createPacket.entityId = entity->GetId();
-		createPacket.position = nodeComponent.GetPosition();
-		createPacket.rotation = nodeComponent.GetRotation();
-		createPacket.visualName = syncComponent.GetName();
+		m_movingEntities.Remove(entity);
 
-		if (entity->HasComponent<Ndk::PhysicsComponent3D>())
+		if (entityId < m_staticCreatePackets.size())
+			m_staticCreatePackets[entityId].reset();
+
+		for (PlayerData& playerData : m_players)
 		{
-			auto& physComponent = entity->GetComponent<Ndk::PhysicsComponent3D>();
+			playerData.pendingEntities.UnboundedReset(entityId);
 
-			createPacket.angularVelocity = physComponent.GetAngularVelocity();
-			createPacket.linearVelocity = physComponent.GetLinearVelocity();
+			if (playerData.visibleEntities.UnboundedTest(entityId))
+				DeleteEntity(playerData, entity);
 		}
+	}
+
+	void BroadcastSystem::OnEntityValidation(Ndk::Entity* entity, bool justAdded)
+	{
+		Ndk::EntityId entityId = entity->GetId();
+
+		// Components may have changed, serialize creation again next time it's needed
+		if (entityId < m_staticCreatePackets.size())
+			m_staticCreatePackets[entityId].reset();
+
+		if (entity->HasComponent<Ndk::PhysicsComponent3D>())
+			m_movingEntities.Insert(entity);
 		else
 		{
-			createPacket.angularVelocity = Nz::Vector3f::Zero();
-			createPacket.linearVelocity = Nz::Vector3f::Zero();
+			m_movingEntities.Remove(entity);
+
+			// Static entities are sent to everyone, through the creation queue
+			for (PlayerData& playerData : m_players)
+			{
+				if (!playerData.visibleEntities.UnboundedTest(entityId) && !playerData.pendingEntities.UnboundedTest(entityId))
+				{
+					playerData.pendingEntities.UnboundedSet(entityId);
+					playerData.pendingQueue.emplace_back(entity);
+				}
+			}
 		}
 	}
 
-	void BroadcastSystem::CreateAllEntities(std::vector<Packets::CreateEntity>& packetVector)
+	void BroadcastSystem::OnUpdate(float /*elapsedTime*/)
 	{
-		for (const Ndk::EntityHandle& entity : GetEntities())
+		Nz::UInt16 snapshotId = m_snapshotId++;
+		Nz::UInt64 serverTime = ServerApplication::GetAppTime();
+
+		Ndk::World& world = GetWorld();
+
+		for (PlayerData& playerData : m_players)
 		{
-			packetVector.emplace_back();
-			BuildCreateEntity(entity, packetVector.back());
+			FillInterestAreas(playerData);
+
+			FillRelevantEntities(playerData);
+
+			// Delete visible entities which left player interest
+			for (std::size_t entityId = playerData.visibleEntities.FindFirst(); entityId != playerData.visibleEntities.npos; entityId = playerData.visibleEntities.FindNext(entityId))
+			{
+				if (m_movingEntities.Has(entityId) && !m_relevantEntities.UnboundedTest(entityId))
+					DeleteEntity(playerData, world.GetEntity(entityId));
+			}
+
+			// Stream entities entering player interest and sort relevant ones by their priority accumulator
+			m_priorityQueue.clear();
+
+			// Limit how many entities the client has to create per update, the others will be created on the next ones
+			std::size_t creationBudget = MaxEntityCreationPerUpdate;
+
+			for (std::size_t entityId = m_relevantEntities.FindFirst(); entityId != m_relevantEntities.npos; entityId = m_relevantEntities.FindNext(entityId))
+			{
+				const Ndk::EntityHandle& entity = world.GetEntity(entityId);
+
+				if (!playerData.visibleEntities.UnboundedTest(entityId))
+				{
+					// The controlled entity is never delayed
+					if (creationBudget == 0 && entity != playerData.player->GetControlledEntity())
+						continue;
+
+					CreateEntity(playerData, entity);
+					if (creationBudget > 0)
+						creationBudget--;
+				}
+
+				Nz::UInt16& priorityAccumulator = playerData.priorityAccumulators[entityId];
+
+				Nz::UInt16 newPriority = priorityAccumulator + entity->GetComponent<SynchronizedComponent>().GetPriority();
+				if (newPriority < priorityAccumulator) // Overflow protection
+					priorityAccumulator = std::numeric_limits<Nz::UInt16>::max();
+				else
+					priorityAccumulator = newPriority;
+
+				if (priorityAccumulator == 0)
+					continue;
+
+				auto& priorityData = m_priorityQueue.emplace_back();
+				priorityData.entity = entity;
+				priorityData.priority = priorityAccumulator;
+			}
+
+			CreatePendingEntities(playerData, creationBudget);
+
+			std::sort(m_priorityQueue.begin(), m_priorityQueue.end(), [](const EntityPriority& lhs, const EntityPriority& rhs)
+			{
+				return lhs.priority > rhs.priority;
+			});
+
+			ArenaStateHistory& stateHistory = playerData.player->GetArenaStateHistory();
+
+			m_arenaStatePacket.stateId = snapshotId;
+			m_arenaStatePacket.baselineId = snapshotId;
+			m_arenaStatePacket.serverTime = serverTime;
+			m_arenaStatePacket.entities.clear();
+			m_arenaStatePacket.removedEntities.clear();
+
+			std::size_t packetSize = ArenaStateHistory::MaxHeaderSize;
+
+			// Delta-compress against the last state the player acknowledged, if we still have it
+			if (const std::optional<Nz::UInt16>& acknowledgedStateId = playerData.player->GetLastAcknowledgedStateId(); acknowledgedStateId && stateHistory.HasState(*acknowledgedStateId))
+			{
+				// Entities the client deleted don't have to be kept in its states
+				stateHistory.ComputeRemovedEntities(*acknowledgedStateId, [&](Nz::UInt32 entityId)
+				{
+					return !playerData.visibleEntities.UnboundedTest(entityId);
+				}, m_arenaStatePacket.removedEntities);
+
+				std::size_t removedSize = 0;
+				for (Nz::UInt32 entityId : m_arenaStatePacket.removedEntities)
+					removedSize += ArenaStateHistory::ComputeIdSize(entityId);
+
+				// A full state is cheaper than a huge removal list
+				if (packetSize + removedSize <= MaxStateSize / 2)
+				{
+					m_arenaStatePacket.baselineId = *acknowledgedStateId;
+					packetSize += removedSize;
+				}
+				else
+					m_arenaStatePacket.removedEntities.clear();
+			}
+
+			// Fill player packet by priority order, with what each entity actually costs against the baseline
+			const Ndk::EntityHandle& controlledEntity = playerData.player->GetControlledEntity();
+			for (const EntityPriority& priorityData : m_priorityQueue)
+			{
+				Ndk::Entity* entity = priorityData.entity;
+
+				auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+				Packets::ArenaState::Entity& entityData = m_arenaStatePacket.entities.emplace_back();
+				entityData.id = entity->GetId();
+				entityData.angularVelocity = entityPhys.GetAngularVelocity();
+				entityData.linearVelocity = entityPhys.GetLinearVelocity();
+				entityData.position = entityPhys.GetPosition();
+				entityData.rotation = entityPhys.GetRotation();
+				entityData.fields = (m_arenaStatePacket.baselineId != snapshotId) ? stateHistory.ComputeChangedFields(m_arenaStatePacket.baselineId, entityData) : Packets::ArenaState::EntityField_All;
+
+				// Unchanged entities are left out, the client keeps them from the baseline (except the controlled one, prediction wants a state on every update)
+				if (entityData.fields == 0 && entity != controlledEntity)
+				{
+					m_arenaStatePacket.entities.pop_back();
+					playerData.priorityAccumulators[entity->GetId()] = 0;
+					continue;
+				}
+
+				std::size_t entitySize = ArenaStateHistory::ComputeEntitySize(entityData);
+				if (packetSize + entitySize > MaxStateSize)
+				{
+					m_arenaStatePacket.entities.pop_back();
+					break;
+				}
+
+				packetSize += entitySize;
+				playerData.priorityAccumulators[entity->GetId()] = 0;
+			}
+
+			// Next states will be delta-compressed against what the client will rebuild from this one
+			stateHistory.RegisterState(m_arenaStatePacket);
+
+			BroadcastStateUpdate(this, playerData.player, m_arenaStatePacket);
 		}
+
+		for (Ndk::EntityId entityId : m_serializedMovingEntities)
+			m_movingCreatePackets[entityId].reset();
+
+		m_serializedMovingEntities.clear();
+	}
+
+	NetworkReactor::SharedPacket BroadcastSystem::SerializeCreateEntity(Ndk::Entity* entity)
+	{
+		Packets::CreateEntity createPacket;
+		BuildCreateEntity(entity, createPacket);
+
+		std::shared_ptr<Nz::NetPacket> sharedPacket = std::make_shared<Nz::NetPacket>();
+		m_app->GetCommandStore().SerializePacket(*sharedPacket, createPacket);
+
+		return sharedPacket;
+	}
+
+	NetworkReactor::SharedPacket BroadcastSystem::SerializeDeleteEntity(Ndk::EntityId entityId)
+	{
+		Packets::DeleteEntity deletePacket;
+		deletePacket.id = entityId;
+
+		std::shared_ptr<Nz::NetPacket> sharedPacket = std::make_shared<Nz::NetPacket>();
+		m_app->GetCommandStore().SerializePacket(*sharedPacket, deletePacket);
+
+		return sharedPacket;
 	}
 
 	Ndk::SystemIndex BroadcastSystem::systemIndex;
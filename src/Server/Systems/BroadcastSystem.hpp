@@ -7,31 +7,57 @@
 #ifndef EREWHON_SERVER_BROADCASTSYSTEM_HPP
 #define EREWHON_SERVER_BROADCASTSYSTEM_HPP
 
+#include <Nazara/Core/Bitset.hpp>
 #include <NDK/EntityList.hpp>
 #include <NDK/System.hpp>
+#include <Shared/NetworkReactor.hpp>
 #include <Shared/Protocol/Packets.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
 #include <vector>
 
 namespace ewn
 {
+	class Player;
 	class ServerApplication;
 
 	class BroadcastSystem : public Ndk::System<BroadcastSystem>
 	{
 		public:
-			BroadcastSystem();
+			BroadcastSystem(ServerApplication* app);
 			~BroadcastSystem() = default;
 
+			void AddPlayer(Player* player);
+
 			void BuildCreateEntity(Ndk::Entity* entity, Packets::CreateEntity& createPacket);
-			void CreateAllEntities(std::vector<Packets::CreateEntity>& packetVector);
 
-			NazaraSignal(BroadcastEntityCreation, const BroadcastSystem*, const Packets::CreateEntity& /*packet*/);
-			NazaraSignal(BroadcastEntityDestruction, const BroadcastSystem*, const Packets::DeleteEntity& /*packet*/);
-			NazaraSignal(BroadcastStateUpdate, const BroadcastSystem*, Packets::ArenaState& /*statePacket*/);
+			inline float GetInterestRadius() const;
+
+			void RemovePlayer(Player* player);
+
+			inline void SetInterestRadius(float radius);
+
+			NazaraSignal(BroadcastEntityCreation, const BroadcastSystem*, Player* /*player*/, const NetworkReactor::SharedPacket& /*createPacket*/);
+			NazaraSignal(BroadcastEntityDestruction, const BroadcastSystem*, Player* /*player*/, const NetworkReactor::SharedPacket& /*deletePacket*/);
+			NazaraSignal(BroadcastStateUpdate, const BroadcastSystem*, Player* /*player*/, Packets::ArenaState& /*statePacket*/);
 
 			static Ndk::SystemIndex systemIndex;
 
+			static constexpr std::size_t MaxEntityCreationPerUpdate = 64;
+			static constexpr std::size_t MaxStateSize = 1300; //< Bytes, to fit in a single ENet packet
+
 		private:
+			struct InterestArea;
+			struct PlayerData;
+
+			void CreateEntity(PlayerData& playerData, Ndk::Entity* entity);
+			void CreatePendingEntities(PlayerData& playerData, std::size_t maxCount);
+			void DeleteEntity(PlayerData& playerData, Ndk::Entity* entity);
+			void FillInterestAreas(PlayerData& playerData);
+			void FillRelevantEntities(const PlayerData& playerData);
+			bool IsRelevant(const PlayerData& playerData, Ndk::Entity* entity, bool isVisible) const;
+			NetworkReactor::SharedPacket SerializeCreateEntity(Ndk::Entity* entity);
+			NetworkReactor::SharedPacket SerializeDeleteEntity(Ndk::EntityId entityId);
+
 			void OnEntityRemoved(Ndk::Entity* entity) override;
 			void OnEntityValidation(Ndk::Entity* entity, bool justAdded) override;
 			void OnUpdate(float elapsedTime) override;
@@ -42,13 +68,39 @@ namespace ewn
 				Nz::UInt16 priority;
 			};
 
+			struct InterestArea
+			{
+				Nz::Vector3f center;
+				float radius;
+			};
+
+			struct PlayerData
+			{
+				Player* player;
+				Nz::Bitset<Nz::UInt64> pendingEntities; //< Static entities queued for creation
+				Nz::Bitset<Nz::UInt64> visibleEntities; //< Entities the client knows about (CreateEntity sent)
+				Nz::Vector3f lastViewPosition;
+				std::vector<Ndk::EntityHandle> pendingQueue;
+				std::vector<Nz::UInt16> priorityAccumulators; //< Indexed by entity id
+			};
+
+			// Entities stay visible a bit further than where they become visible, to prevent create/delete spam at the border
+			static constexpr float VisibleMargin = 1.1f;
+
 			std::vector<EntityPriority> m_priorityQueue;
+			std::vector<InterestArea> m_interestAreas;
+			std::vector<Ndk::EntityId> m_serializedMovingEntities;
+			std::vector<NetworkReactor::SharedPacket> m_deletePackets; //< Indexed by entity id
+			std::vector<NetworkReactor::SharedPacket> m_movingCreatePackets; //< Indexed by entity id, only valid during an update
+			std::vector<NetworkReactor::SharedPacket> m_staticCreatePackets; //< Indexed by entity id
+			std::vector<PlayerData> m_players;
+			std::vector<SpatialSystem::Entry> m_nearbyEntries;
+			Nz::Bitset<Nz::UInt64> m_relevantEntities;
 			Ndk::EntityList m_movingEntities;
 			Nz::UInt16 m_snapshotId;
 			Packets::ArenaState m_arenaStatePacket;
 			ServerApplication* m_app;
-			float m_stateUpdateAccumulator;
-			float m_stateUpdateFrequency;
+			float m_interestRadius;
 	};
 }
 
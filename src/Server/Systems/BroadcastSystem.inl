@@ -6,4 +6,13 @@
 
 namespace ewn
 {
+	inline float BroadcastSystem::GetInterestRadius() const
+	{
+		return m_interestRadius;
+	}
+
+	inline void BroadcastSystem::SetInterestRadius(float radius)
+	{
+		m_interestRadius = radius;
+	}
 }
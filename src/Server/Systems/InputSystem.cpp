@@ -5,6 +5,7 @@
 #include <Server/Systems/InputSystem.hpp>
 #include <Nazara/Utility/Node.hpp>
 #include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Shared/SpaceshipMovement.hpp>
 #include <Server/Components/InputComponent.hpp>
 #include <iostream>
 
@@ -26,19 +27,13 @@ namespace ewn
 			Nz::UInt64 lastInput = spaceshipInput.GetLastInputTime();
 			spaceshipInput.ProcessInputs([&] (Nz::UInt64 time, const Nz::Vector3f& movement, const Nz::Vector3f& rotation)
 			{
-				static constexpr float AngularMultiplier = 3000.f;
-				static constexpr float ForceMultiplier = 15000.f;
-
 				float inputElapsedTime = (lastInput != 0) ? (time - lastInput) / 1000.f : 0.f;
 
-				Nz::Vector3f totalMovement = inputElapsedTime * movement;
-				Nz::Vector3f totalRotation = inputElapsedTime * rotation;
-
-				spaceshipPhysics.AddForce(ForceMultiplier * totalMovement, Nz::CoordSys_Local);
-				spaceshipPhysics.AddTorque(AngularMultiplier * totalRotation, Nz::CoordSys_Global);
+				spaceshipPhysics.AddForce(SpaceshipMovement::ComputeForce(inputElapsedTime, movement), Nz::CoordSys_Local);
+				spaceshipPhysics.AddTorque(SpaceshipMovement::ComputeTorque(inputElapsedTime, rotation), Nz::CoordSys_Global);
 
-				/*std::cout << "At " << time << ": Move by " << totalMovement << " (final pos: " << spaceshipPhysics.GetPosition() << ")\n";
-				std::cout << "   " << time << ": Rotate by " << totalRotation << " (final pos: " << spaceshipPhysics.GetRotation().ToEulerAngles() << ')' << std::endl;*/
+				/*std::cout << "At " << time << ": Move by " << inputElapsedTime * movement << " (final pos: " << spaceshipPhysics.GetPosition() << ")\n";
+				std::cout << "   " << time << ": Rotate by " << inputElapsedTime * rotation << " (final pos: " << spaceshipPhysics.GetRotation().ToEulerAngles() << ')' << std::endl;*/
 
 				lastInput = time;
 			});
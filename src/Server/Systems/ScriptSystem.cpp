@@ -4,9 +4,12 @@
 
 #include <Server/Systems/ScriptSystem.hpp>
 #include <Server/Arena.hpp>
+#include <Server/ServerApplication.hpp>
 #include <Server/Components/OwnerComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
 #include <Server/Components/SynchronizedComponent.hpp>
+#include <algorithm>
+#include <thread>
 
 namespace ewn
 {
@@ -21,13 +24,64 @@ namespace ewn
 
 	void ScriptSystem::OnUpdate(float elapsedTime)
 	{
+		// Helper jobs may be picked up after the update they were dispatched for, don't reuse a batch one of them still holds
+		if (!m_batch || m_batch.use_count() > 1)
+			m_batch = std::make_shared<ScriptBatch>();
+
+		ScriptBatch& batch = *m_batch;
+		batch.runs.clear();
+
+		// Modules and callback queues are updated here as they may touch other entities
 		for (const Ndk::EntityHandle& entity : GetEntities())
 		{
 			ScriptComponent& script = entity->GetComponent<ScriptComponent>();
+			if (script.Update(elapsedTime))
+			{
+				ScriptRun& run = batch.runs.emplace_back();
+				run.script = &script;
+			}
+		}
+
+		std::size_t scriptCount = batch.runs.size();
+		if (scriptCount > 0)
+		{
+			batch.finishedCount.store(0, std::memory_order_relaxed);
+			batch.nextIndex.store(0, std::memory_order_release);
+
+			// Module Lua APIs only read the world and record every change (including entity handle creation/destruction) as actions,
+			// so game workers can run scripts while this thread handles its own share
+			std::size_t helperCount = std::min(m_app->GetWorkerCount(), (scriptCount - 1) / MinScriptPerJob);
+			for (std::size_t i = 0; i < helperCount; ++i)
+				m_app->DispatchWork([batch = m_batch]() { RunScripts(*batch); });
+
+			RunScripts(batch);
+
+			while (batch.finishedCount.load(std::memory_order_acquire) < scriptCount)
+				std::this_thread::yield();
+		}
+
+		// Apply recorded actions in entity order, no matter which thread ran the script
+		for (const Ndk::EntityHandle& entity : GetEntities())
+			entity->GetComponent<ScriptComponent>().FlushActions();
+
+		for (const ScriptRun& run : batch.runs)
+		{
+			if (!run.succeeded)
+				run.script->SendMessage(BotMessageType::Error, run.lastError);
+		}
+	}
+
+	void ScriptSystem::RunScripts(ScriptBatch& batch)
+	{
+		std::size_t scriptCount = batch.runs.size();
+
+		std::size_t scriptIndex;
+		while ((scriptIndex = batch.nextIndex.fetch_add(1, std::memory_order_acq_rel)) < scriptCount)
+		{
+			ScriptRun& run = batch.runs[scriptIndex];
+			run.succeeded = run.script->Run(&run.lastError);
 
-			Nz::String lastError;
-			if (!script.Run(m_app, elapsedTime, &lastError))
-				script.SendMessage(BotMessageType::Error, lastError);
+			batch.finishedCount.fetch_add(1, std::memory_order_release);
 		}
 	}
 
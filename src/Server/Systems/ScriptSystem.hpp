@@ -7,11 +7,16 @@
 #ifndef EREWHON_SERVER_SCRIPTSYSTEM_HPP
 #define EREWHON_SERVER_SCRIPTSYSTEM_HPP
 
+#include <Nazara/Core/String.hpp>
 #include <NDK/System.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace ewn
 {
 	class Arena;
+	class ScriptComponent;
 	class ServerApplication;
 
 	class ScriptSystem : public Ndk::System<ScriptSystem>
@@ -22,9 +27,30 @@ namespace ewn
 
 			static Ndk::SystemIndex systemIndex;
 
+			static constexpr std::size_t MinScriptPerJob = 4;
+
 		private:
+			struct ScriptBatch;
+
 			void OnUpdate(float elapsedTime) override;
 
+			static void RunScripts(ScriptBatch& batch);
+
+			struct ScriptRun
+			{
+				ScriptComponent* script;
+				Nz::String lastError;
+				bool succeeded;
+			};
+
+			struct ScriptBatch
+			{
+				std::atomic_size_t finishedCount;
+				std::atomic_size_t nextIndex;
+				std::vector<ScriptRun> runs;
+			};
+
+			std::shared_ptr<ScriptBatch> m_batch;
 			Arena* m_arena;
 			ServerApplication* m_app;
 	};
@@ -0,0 +1,108 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Systems/SpatialSystem.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Server/Components/SignatureComponent.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	namespace
+	{
+		bool IsFinite(const Nz::Vector3f& vec)
+		{
+			return std::isfinite(vec.x) && std::isfinite(vec.y) && std::isfinite(vec.z);
+		}
+	}
+
+	SpatialSystem::SpatialSystem() :
+	m_cellSize(100.f)
+	{
+		Requires<Ndk::NodeComponent, Ndk::PhysicsComponent3D>();
+		SetUpdateOrder(-1); //< Before physics, so collision callbacks only see entities alive this tick
+	}
+
+	void SpatialSystem::QueryBox(const Nz::Boxf& box, std::vector<Entry>& results) const
+	{
+		if (!IsFinite(box.GetMinimum()) || !IsFinite(box.GetMaximum()))
+			return;
+
+		ForEachEntryInCells(box.GetMinimum(), box.GetMaximum(), [&](const Entry& entry)
+		{
+			if (box.Contains(entry.position))
+				results.push_back(entry);
+		});
+	}
+
+	void SpatialSystem::QuerySphere(const Nz::Vector3f& center, float radius, std::vector<Entry>& results) const
+	{
+		if (!IsFinite(center) || !std::isfinite(radius) || radius < 0.f)
+			return;
+
+		float squaredRadius = radius * radius;
+
+		ForEachEntryInCells(center - Nz::Vector3f(radius), center + Nz::Vector3f(radius), [&](const Entry& entry)
+		{
+			if (entry.position.SquaredDistance(center) < squaredRadius)
+				results.push_back(entry);
+		});
+	}
+
+	void SpatialSystem::OnUpdate(float /*elapsedTime*/)
+	{
+		const auto& entities = GetEntities();
+
+		m_entries.clear();
+		m_entries.reserve(entities.size());
+
+		for (const Ndk::EntityHandle& entity : entities)
+		{
+			IndexedEntry& indexedEntry = m_entries.emplace_back();
+
+			Entry& entry = indexedEntry.entry;
+			entry.entityId = entity->GetId();
+			entry.position = entity->GetComponent<Ndk::PhysicsComponent3D>().GetPosition();
+
+			if (entity->HasComponent<SignatureComponent>())
+			{
+				auto& signatureComponent = entity->GetComponent<SignatureComponent>();
+				entry.emSignature = signatureComponent.GetEmSignature();
+				entry.hasSignature = true;
+				entry.signature = signatureComponent.GetSignature();
+				entry.size = signatureComponent.GetSize();
+			}
+			else
+			{
+				entry.emSignature = 0.0;
+				entry.hasSignature = false;
+				entry.signature = entity->GetId();
+				entry.size = -1.0;
+			}
+
+			indexedEntry.cellKey = ComputeCellKey(ComputeCell(entry.position));
+		}
+
+		std::sort(m_entries.begin(), m_entries.end(), [](const IndexedEntry& lhs, const IndexedEntry& rhs)
+		{
+			return lhs.cellKey < rhs.cellKey;
+		});
+
+		m_cells.clear();
+		for (std::size_t i = 0; i < m_entries.size();)
+		{
+			Nz::UInt64 cellKey = m_entries[i].cellKey;
+
+			std::size_t first = i;
+			while (i < m_entries.size() && m_entries[i].cellKey == cellKey)
+				++i;
+
+			m_cells.emplace(cellKey, CellRange{ first, i });
+		}
+	}
+
+	Ndk::SystemIndex SpatialSystem::systemIndex;
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_SPATIALSYSTEM_HPP
+#define EREWHON_SERVER_SPATIALSYSTEM_HPP
+
+#include <Nazara/Math/Box.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <NDK/System.hpp>
+#include <hopstotch/hopscotch_map.h>
+#include <vector>
+
+namespace ewn
+{
+	// Uniform grid of physical entities, rebuilt each tick, for gameplay queries (radar, communications, explosions, ...)
+	class SpatialSystem : public Ndk::System<SpatialSystem>
+	{
+		public:
+			struct Entry;
+
+			SpatialSystem();
+			~SpatialSystem() = default;
+
+			inline float GetCellSize() const;
+
+			void QueryBox(const Nz::Boxf& box, std::vector<Entry>& results) const;
+			void QuerySphere(const Nz::Vector3f& center, float radius, std::vector<Entry>& results) const;
+
+			inline void SetCellSize(float cellSize);
+
+			struct Entry
+			{
+				Ndk::EntityId entityId;
+				Nz::Vector3f position;
+				Nz::Int64 signature;  //< Entity id if the entity has no signature
+				double emSignature;
+				double size;
+				bool hasSignature;
+			};
+
+			static Ndk::SystemIndex systemIndex;
+
+		private:
+			struct CellRange
+			{
+				std::size_t first;
+				std::size_t last;
+			};
+
+			static constexpr unsigned int CellKeyBits = 21;
+			static constexpr int MaxCellCoord = (1 << (CellKeyBits - 1)) - 1;
+
+			inline Nz::Vector3i ComputeCell(const Nz::Vector3f& position) const;
+			static inline Nz::UInt64 ComputeCellKey(const Nz::Vector3i& cell);
+			template<typename F> void ForEachEntryInCells(const Nz::Vector3f& min, const Nz::Vector3f& max, F&& func) const;
+
+			void OnUpdate(float elapsedTime) override;
+
+			struct IndexedEntry
+			{
+				Nz::UInt64 cellKey;
+				Entry entry;
+			};
+
+			tsl::hopscotch_map<Nz::UInt64, CellRange> m_cells;
+			std::vector<IndexedEntry> m_entries; //< Sorted by cell
+			float m_cellSize;
+	};
+}
+
+#include <Server/Systems/SpatialSystem.inl>
+
+#endif // EREWHON_SERVER_SPATIALSYSTEM_HPP
@@ -0,0 +1,76 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Systems/SpatialSystem.hpp>
+#include <Nazara/Core/Algorithm.hpp>
+#include <cassert>
+#include <cmath>
+
+namespace ewn
+{
+	inline float SpatialSystem::GetCellSize() const
+	{
+		return m_cellSize;
+	}
+
+	inline void SpatialSystem::SetCellSize(float cellSize)
+	{
+		assert(cellSize > 0.f);
+
+		m_cellSize = cellSize;
+	}
+
+	inline Nz::Vector3i SpatialSystem::ComputeCell(const Nz::Vector3f& position) const
+	{
+		// Clamp before converting, out of range floats are undefined behavior when cast to int
+		auto ComputeCoord = [&](float value)
+		{
+			return int(Nz::Clamp(std::floor(value / m_cellSize), float(-MaxCellCoord), float(MaxCellCoord)));
+		};
+
+		return Nz::Vector3i(ComputeCoord(position.x), ComputeCoord(position.y), ComputeCoord(position.z));
+	}
+
+	inline Nz::UInt64 SpatialSystem::ComputeCellKey(const Nz::Vector3i& cell)
+	{
+		// 21 bits per axis, which is way more than any arena needs
+		constexpr Nz::UInt64 mask = (1ULL << CellKeyBits) - 1;
+
+		return ((Nz::UInt64(cell.x) & mask) << (2 * CellKeyBits)) | ((Nz::UInt64(cell.y) & mask) << CellKeyBits) | (Nz::UInt64(cell.z) & mask);
+	}
+
+	template<typename F>
+	void SpatialSystem::ForEachEntryInCells(const Nz::Vector3f& min, const Nz::Vector3f& max, F&& func) const
+	{
+		Nz::Vector3i minCell = ComputeCell(min);
+		Nz::Vector3i maxCell = ComputeCell(max);
+
+		// Looking up every cell of a huge query is slower than testing every entry
+		Nz::UInt64 cellCount = Nz::UInt64(maxCell.x - minCell.x + 1) * Nz::UInt64(maxCell.y - minCell.y + 1) * Nz::UInt64(maxCell.z - minCell.z + 1);
+		if (cellCount > m_entries.size())
+		{
+			for (const IndexedEntry& indexedEntry : m_entries)
+				func(indexedEntry.entry);
+
+			return;
+		}
+
+		for (int x = minCell.x; x <= maxCell.x; ++x)
+		{
+			for (int y = minCell.y; y <= maxCell.y; ++y)
+			{
+				for (int z = minCell.z; z <= maxCell.z; ++z)
+				{
+					auto it = m_cells.find(ComputeCellKey(Nz::Vector3i(x, y, z)));
+					if (it == m_cells.end())
+						continue;
+
+					const CellRange& range = it->second;
+					for (std::size_t i = range.first; i < range.last; ++i)
+						func(m_entries[i].entry);
+				}
+			}
+		}
+	}
+}
@@ -16,13 +16,15 @@
 #include <Server/Components/SignatureComponent.hpp>
 #include <Server/Components/SynchronizedComponent.hpp>
 #include <Server/Scripting/ArenaInterface.hpp>
+#include <Server/Scripting/ScriptStatePool.hpp>
+#include <Server/Systems/ArenaBoundsSystem.hpp>
 #include <Server/Systems/BroadcastSystem.hpp>
 #include <Server/Systems/LifeTimeSystem.hpp>
 #include <Server/Systems/NavigationSystem.hpp>
 #include <Server/Systems/ScriptSystem.hpp>
+#include <Server/Systems/SpatialSystem.hpp>
 #include <Server/Systems/InputSystem.hpp>
 #include <Nazara/Core/Initializer.hpp>
-#include <Nazara/Core/Thread.hpp>
 #include <Nazara/Network/Network.hpp>
 #include <NDK/Sdk.hpp>
 
@@ -30,7 +32,12 @@ int main()
 {
 	Nz::Initializer<Nz::Network, Ndk::Sdk> nazara; //< Init SDK before application because of custom components/systems
 
-	Nz::Initializer<ewn::ArenaInterface> binding;
+	Nz::Initializer<ewn::ArenaInterface, ewn::ScriptStatePool> binding;
+	if (!binding)
+	{
+		std::cerr << "Failed to initialize scripting" << std::endl;
+		return EXIT_FAILURE;
+	}
 
 	// Initialize custom components
 	Ndk::InitializeComponent<ewn::ArenaComponent>("Arena");
@@ -45,10 +52,12 @@ int main()
 	Ndk::InitializeComponent<ewn::ScriptComponent>("ScrptCmp");
 	Ndk::InitializeComponent<ewn::SignatureComponent>("SignCmp");
 	Ndk::InitializeComponent<ewn::SynchronizedComponent>("SyncComp");
+	Ndk::InitializeSystem<ewn::ArenaBoundsSystem>();
 	Ndk::InitializeSystem<ewn::BroadcastSystem>();
 	Ndk::InitializeSystem<ewn::LifeTimeSystem>();
 	Ndk::InitializeSystem<ewn::NavigationSystem>();
 	Ndk::InitializeSystem<ewn::ScriptSystem>();
+	Ndk::InitializeSystem<ewn::SpatialSystem>();
 	Ndk::InitializeSystem<ewn::InputSystem>();
 
 	ewn::ServerApplication app;
@@ -65,7 +74,12 @@ int main()
 	}
 
 	const ewn::ConfigFile& config = app.GetConfig();
-	if (!app.SetupNetwork(config.GetIntegerOption<std::size_t>("Game.MaxClients"), 1, Nz::NetProtocol_Any, config.GetIntegerOption<Nz::UInt16>("Game.Port")))
+	std::size_t maxClients = config.GetIntegerOption<std::size_t>("Game.MaxClients");
+	std::size_t reactorCount = config.GetIntegerOption<std::size_t>("Game.ReactorCount");
+
+	// Each reactor listens on its own port (starting from Game.Port), clients pick one of them
+	std::size_t clientPerReactor = (maxClients + reactorCount - 1) / reactorCount;
+	if (!app.SetupNetwork(clientPerReactor, reactorCount, Nz::NetProtocol_Any, config.GetIntegerOption<Nz::UInt16>("Game.Port")))
 	{
 		std::cerr << "Failed to setup network" << std::endl;
 		return EXIT_FAILURE;
@@ -73,20 +87,7 @@ int main()
 
 	std::cout << "Server ready." << std::endl;
 
-	//Nz::UInt64 lastUpdate = Nz::GetElapsedMilliseconds();
-	//unsigned int updateCount = 0;
-	while (app.Run())
-	{
-		/*Nz::UInt64 now = Nz::GetElapsedMilliseconds();
-		if (now - lastUpdate >= 1000)
-		{
-			std::cout << "Update per seconds: " << updateCount << std::endl;
-			updateCount = 0;
-			lastUpdate = now;
-		}
-		updateCount++;*/
-		Nz::Thread::Sleep(1);
-	}
+	while (app.Run());
 
 	std::cout << "Goodbye" << std::endl;
 }
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Shared/CommandStore.hpp>
+#include <Shared/Protocol/CompressedInteger.hpp>
 #include <iostream>
 
 namespace ewn
@@ -10,6 +11,43 @@ namespace ewn
 	CommandStore::~CommandStore() = default;
 
 	bool CommandStore::UnserializePacket(std::size_t peerId, Nz::NetPacket&& packet) const
+	{
+		// Network reactors coalesce messages, each one of them is prefixed by its size
+		std::vector<Nz::UInt8> messageData;
+		while (!packet.EndOfStream())
+		{
+			CompressedUnsigned<Nz::UInt32> messageSize;
+			try
+			{
+				packet >> messageSize;
+			}
+			catch (const std::exception&)
+			{
+				std::cerr << "Failed to unserialize message size" << std::endl;
+				return false;
+			}
+
+			if (messageSize > packet.GetDataSize())
+			{
+				std::cerr << "Client #" << peerId << " sent invalid message size" << std::endl;
+				return false;
+			}
+
+			messageData.resize(messageSize);
+			if (packet.Read(messageData.data(), messageData.size()) != messageData.size())
+			{
+				std::cerr << "Client #" << peerId << " sent truncated message" << std::endl;
+				return false;
+			}
+
+			if (!UnserializeMessage(peerId, Nz::NetPacket(packet.GetNetCode(), messageData.data(), messageData.size())))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool CommandStore::UnserializeMessage(std::size_t peerId, Nz::NetPacket&& packet) const
 	{
 		Nz::UInt8 opcode;
 		try
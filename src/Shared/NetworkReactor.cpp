@@ -5,15 +5,21 @@
 #include <Shared/NetworkReactor.hpp>
 #include <Shared/Config.hpp>
 #include <Shared/Utils.hpp>
+#include <Shared/Protocol/CompressedInteger.hpp>
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
+#include <iterator>
 #include <mutex>
 #include <stdexcept>
 
 namespace ewn
 {
 	NetworkReactor::NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient) :
+	m_peakIncomingCount(0),
+	m_peakOutgoingCount(0),
 	m_firstId(firstId),
+	m_pollToken(m_incomingQueue),
 	m_protocol(protocol)
 	{
 		if (port > 0)
@@ -25,6 +31,9 @@ namespace ewn
 			throw std::runtime_error("Failed to start reactor");
 
 		m_clients.resize(maxClient, nullptr);
+		m_pendingBatches.resize(maxClient * NetworkChannelCount);
+		m_pollEvents.resize(EventBatchSize);
+		m_sendEvents.resize(EventBatchSize);
 
 		m_running.store(true, std::memory_order_release);
 		m_thread = Nz::Thread(&NetworkReactor::WorkerThread, this);
@@ -84,6 +93,17 @@ namespace ewn
 		m_outgoingQueue.enqueue(std::move(outgoingData));
 	}
 
+	NetworkReactor::QueueMetrics NetworkReactor::GetQueueMetrics() const
+	{
+		QueueMetrics metrics;
+		metrics.incomingDepth = m_incomingQueue.size_approx();
+		metrics.outgoingDepth = m_outgoingQueue.size_approx();
+		metrics.peakIncomingCount = m_peakIncomingCount.load(std::memory_order_relaxed);
+		metrics.peakOutgoingCount = m_peakOutgoingCount.load(std::memory_order_relaxed);
+
+		return metrics;
+	}
+
 	void NetworkReactor::QueryInfo(std::size_t peerId)
 	{
 		assert(peerId >= m_firstId);
@@ -111,6 +131,22 @@ namespace ewn
 		m_outgoingQueue.enqueue(std::move(outgoingData));
 	}
 
+	void NetworkReactor::SendData(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, SharedPacket packet)
+	{
+		assert(peerId >= m_firstId);
+
+		OutgoingEvent::SharedPacketEvent packetEvent;
+		packetEvent.channelId = channelId;
+		packetEvent.flags = flags;
+		packetEvent.packet = std::move(packet);
+
+		OutgoingEvent outgoingData;
+		outgoingData.peerId = peerId - m_firstId;
+		outgoingData.data = std::move(packetEvent);
+
+		m_outgoingQueue.enqueue(std::move(outgoingData));
+	}
+
 	void NetworkReactor::WorkerThread()
 	{
 		moodycamel::ConsumerToken connectionToken(m_connectionRequests);
@@ -127,6 +163,27 @@ namespace ewn
 		}
 	}
 
+	void NetworkReactor::FlushBatch(std::size_t batchIndex)
+	{
+		PendingBatch& batch = m_pendingBatches[batchIndex];
+		if (batch.messageCount == 0)
+			return;
+
+		std::size_t peerId = batchIndex / NetworkChannelCount;
+		Nz::UInt8 channelId = static_cast<Nz::UInt8>(batchIndex % NetworkChannelCount);
+
+		if (Nz::ENetPeer* peer = m_clients[peerId])
+			peer->Send(channelId, batch.flags, std::move(batch.packet));
+
+		batch.messageCount = 0;
+	}
+
+	void NetworkReactor::FlushPeerBatches(std::size_t peerId)
+	{
+		for (std::size_t channelId = 0; channelId < NetworkChannelCount; ++channelId)
+			FlushBatch(peerId * NetworkChannelCount + channelId);
+	}
+
 	void NetworkReactor::HandleConnectionRequests(const moodycamel::ConsumerToken& token)
 {
 		ConnectionRequest request;
@@ -144,6 +201,36 @@ namespace ewn
 		}
 	}
 
+	void NetworkReactor::QueueMessage(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& message)
+	{
+		constexpr std::size_t MaxSizePrefixSize = 5; //< Compressed UInt32
+
+		if (!m_clients[peerId])
+			return;
+
+		const Nz::UInt8* messageData = static_cast<const Nz::UInt8*>(message.GetConstData()) + Nz::NetPacket::HeaderSize;
+		std::size_t messageSize = message.GetDataSize();
+
+		std::size_t batchIndex = peerId * NetworkChannelCount + channelId;
+		PendingBatch& batch = m_pendingBatches[batchIndex];
+
+		// Messages with different flags can't share an ENet packet, send the previous ones first to keep ordering
+		if (batch.messageCount > 0 && (batch.flags != flags || batch.packet.GetDataSize() + MaxSizePrefixSize + messageSize > MaxBatchSize))
+			FlushBatch(batchIndex);
+
+		if (batch.messageCount == 0)
+		{
+			batch.flags = flags;
+			batch.packet.Reset(message.GetNetCode(), std::max(MaxBatchSize, MaxSizePrefixSize + messageSize));
+
+			m_activeBatches.push_back(batchIndex);
+		}
+
+		batch.packet << CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(messageSize));
+		batch.packet.Write(messageData, messageSize);
+		batch.messageCount++;
+	}
+
 	void NetworkReactor::ReceivePackets(const moodycamel::ProducerToken& producterToken)
 	{
 		Nz::ENetEvent event;
@@ -165,7 +252,7 @@ namespace ewn
 						newEvent.peerId = m_firstId + peerId;
 						newEvent.data.emplace<IncomingEvent::DisconnectEvent>(std::move(disconnectEvent));
 
-						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+						m_receivedEvents.emplace_back(std::move(newEvent));
 						break;
 					}
 
@@ -183,7 +270,7 @@ namespace ewn
 						newEvent.peerId = m_firstId + peerId;
 						newEvent.data.emplace<IncomingEvent::ConnectEvent>(std::move(connectEvent));
 
-						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+						m_receivedEvents.emplace_back(std::move(newEvent));
 						break;
 					}
 
@@ -198,7 +285,7 @@ namespace ewn
 						newEvent.peerId = m_firstId + peerId;
 						newEvent.data.emplace<IncomingEvent::PacketEvent>(std::move(packetEvent));
 
-						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+						m_receivedEvents.emplace_back(std::move(newEvent));
 						break;
 					}
 
@@ -207,76 +294,102 @@ namespace ewn
 				}
 			}
 			while (m_host.CheckEvents(&event));
+
+			// Publish every event of this service at once
+			m_incomingQueue.enqueue_bulk(producterToken, std::make_move_iterator(m_receivedEvents.begin()), m_receivedEvents.size());
+			m_receivedEvents.clear();
 		}
 	}
 
-	void NetworkReactor::SendPackets(const moodycamel::ProducerToken& producterToken, const moodycamel::ConsumerToken& token)
+	void NetworkReactor::SendPackets(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token)
 	{
-		OutgoingEvent outEvent;
-		while (m_outgoingQueue.try_dequeue(outEvent))
+		std::size_t eventCount;
+		std::size_t totalCount = 0;
+		while ((eventCount = m_outgoingQueue.try_dequeue_bulk(token, m_sendEvents.begin(), m_sendEvents.size())) > 0)
 		{
-			std::visit([&](auto&& arg) {
-				using T = std::decay_t<decltype(arg)>;
-				if constexpr (std::is_same_v<T, OutgoingEvent::DisconnectEvent>)
-				{
-					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+			for (std::size_t i = 0; i < eventCount; ++i)
+			{
+				OutgoingEvent& outEvent = m_sendEvents[i];
+
+				std::visit([&](auto&& arg) {
+					using T = std::decay_t<decltype(arg)>;
+					if constexpr (std::is_same_v<T, OutgoingEvent::DisconnectEvent>)
 					{
-						switch (arg.type)
+						// Messages sent before the disconnection have to go first
+						FlushPeerBatches(outEvent.peerId);
+
+						if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
 						{
-							case DisconnectionType::Kick:
+							switch (arg.type)
 							{
-								peer->DisconnectNow(arg.data);
+								case DisconnectionType::Kick:
+								{
+									peer->DisconnectNow(arg.data);
 
-								// DisconnectNow does not generate Disconnect event
-								m_clients[outEvent.peerId] = nullptr;
+									// DisconnectNow does not generate Disconnect event
+									m_clients[outEvent.peerId] = nullptr;
 
-								IncomingEvent newEvent;
-								newEvent.peerId = m_firstId + outEvent.peerId;
+									IncomingEvent newEvent;
+									newEvent.peerId = m_firstId + outEvent.peerId;
 
-								auto& disconnectEvent = newEvent.data.emplace<IncomingEvent::DisconnectEvent>();
-								disconnectEvent.data = 0;
+									auto& disconnectEvent = newEvent.data.emplace<IncomingEvent::DisconnectEvent>();
+									disconnectEvent.data = 0;
 
-								m_incomingQueue.enqueue(producterToken, std::move(newEvent));
-								break;
-							}
+									m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+									break;
+								}
 
-							case DisconnectionType::Later:
-								peer->DisconnectLater(arg.data);
-								break;
+								case DisconnectionType::Later:
+									peer->DisconnectLater(arg.data);
+									break;
 
-							case DisconnectionType::Normal:
-								peer->Disconnect(arg.data);
-								break;
+								case DisconnectionType::Normal:
+									peer->Disconnect(arg.data);
+									break;
 
-							default:
-								assert(!"Unknown disconnection type");
-								break;
+								default:
+									assert(!"Unknown disconnection type");
+									break;
+							}
 						}
 					}
-				}
-				else if constexpr (std::is_same_v<T, OutgoingEvent::PacketEvent>)
-				{
-					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
-						peer->Send(arg.channelId, arg.flags, std::move(arg.packet));
-				}
-				else if constexpr (std::is_same_v<T, OutgoingEvent::QueryPeerInfo>)
-				{
-					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+					else if constexpr (std::is_same_v<T, OutgoingEvent::PacketEvent>)
+						QueueMessage(outEvent.peerId, arg.channelId, arg.flags, arg.packet);
+					else if constexpr (std::is_same_v<T, OutgoingEvent::SharedPacketEvent>)
+						QueueMessage(outEvent.peerId, arg.channelId, arg.flags, *arg.packet);
+					else if constexpr (std::is_same_v<T, OutgoingEvent::QueryPeerInfo>)
 					{
-						IncomingEvent newEvent;
-						newEvent.peerId = m_firstId + outEvent.peerId;
+						if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+						{
+							IncomingEvent newEvent;
+							newEvent.peerId = m_firstId + outEvent.peerId;
 
-						auto& peerInfo = newEvent.data.emplace<PeerInfo>();
-						peerInfo.lastReceiveTime = m_host.GetServiceTime() - peer->GetLastReceiveTime();
-						peerInfo.ping = peer->GetRoundTripTime();
+							auto& peerInfo = newEvent.data.emplace<PeerInfo>();
+							peerInfo.lastReceiveTime = m_host.GetServiceTime() - peer->GetLastReceiveTime();
+							peerInfo.ping = peer->GetRoundTripTime();
 
-						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+							m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+						}
 					}
-				}
-				else
-					static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+					else
+						static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
+
+				}, outEvent.data);
+
+				// Don't keep packets alive until this slot is reused
+				outEvent = OutgoingEvent();
+			}
 
-			}, outEvent.data);
+			totalCount += eventCount;
 		}
+
+		if (totalCount > m_peakOutgoingCount.load(std::memory_order_relaxed))
+			m_peakOutgoingCount.store(totalCount, std::memory_order_relaxed);
+
+		// Send everything coalesced during this pass
+		for (std::size_t batchIndex : m_activeBatches)
+			FlushBatch(batchIndex);
+
+		m_activeBatches.clear();
 	}
 }
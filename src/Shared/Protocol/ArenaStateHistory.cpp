@@ -0,0 +1,165 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/ArenaStateHistory.hpp>
+#include <algorithm>
+
+namespace ewn
+{
+	namespace
+	{
+		using Entity = Packets::ArenaState::Entity;
+
+		const Entity* FindEntity(const std::vector<Entity>& entities, Nz::UInt32 entityId)
+		{
+			auto it = std::lower_bound(entities.begin(), entities.end(), entityId, [](const Entity& entity, Nz::UInt32 id)
+			{
+				return entity.id < id;
+			});
+
+			if (it == entities.end() || it->id != entityId)
+				return nullptr;
+
+			return &*it;
+		}
+	}
+
+	// Fields which have to be sent for this entity against a baseline (none if it didn't change)
+	Nz::UInt8 ArenaStateHistory::ComputeChangedFields(Nz::UInt16 baselineId, const Entity& entity) const
+	{
+		const State* baseline = GetState(baselineId);
+		if (!baseline)
+			return Packets::ArenaState::EntityField_All;
+
+		// Entities missing from the baseline are sent in full
+		const Entity* baselineEntity = FindEntity(baseline->entities, entity.id);
+		if (!baselineEntity)
+			return Packets::ArenaState::EntityField_All;
+
+		Nz::UInt8 fields = 0;
+		if (entity.angularVelocity != baselineEntity->angularVelocity)
+			fields |= Packets::ArenaState::EntityField_AngularVelocity;
+
+		if (entity.linearVelocity != baselineEntity->linearVelocity)
+			fields |= Packets::ArenaState::EntityField_LinearVelocity;
+
+		if (entity.position != baselineEntity->position)
+			fields |= Packets::ArenaState::EntityField_Position;
+
+		if (entity.rotation != baselineEntity->rotation)
+			fields |= Packets::ArenaState::EntityField_Rotation;
+
+		return fields;
+	}
+
+	// Registers a resolved state: delta-compressed states keep the baseline entities they don't list or remove
+	void ArenaStateHistory::RegisterState(const Packets::ArenaState& state)
+	{
+		m_mergedEntities.assign(state.entities.begin(), state.entities.end());
+		std::sort(m_mergedEntities.begin(), m_mergedEntities.end(), [](const Entity& lhs, const Entity& rhs)
+		{
+			return lhs.id < rhs.id;
+		});
+
+		if (state.baselineId != state.stateId)
+		{
+			if (const State* baseline = GetState(state.baselineId))
+			{
+				std::size_t listedCount = m_mergedEntities.size();
+				for (const Entity& baselineEntity : baseline->entities)
+				{
+					auto listedEnd = m_mergedEntities.begin() + listedCount;
+					bool isListed = std::binary_search(m_mergedEntities.begin(), listedEnd, baselineEntity, [](const Entity& lhs, const Entity& rhs)
+					{
+						return lhs.id < rhs.id;
+					});
+
+					if (isListed || std::find(state.removedEntities.begin(), state.removedEntities.end(), Nz::UInt32(baselineEntity.id)) != state.removedEntities.end())
+						continue;
+
+					m_mergedEntities.push_back(baselineEntity);
+				}
+
+				std::inplace_merge(m_mergedEntities.begin(), m_mergedEntities.begin() + listedCount, m_mergedEntities.end(), [](const Entity& lhs, const Entity& rhs)
+				{
+					return lhs.id < rhs.id;
+				});
+			}
+		}
+
+		// Baseline may be stored in the slot we're overwriting, hence the merge buffer
+		State& historyState = m_states[state.stateId % Capacity];
+		historyState.isValid = true;
+		historyState.stateId = state.stateId;
+
+		std::swap(historyState.entities, m_mergedEntities);
+	}
+
+	// Fills fields listed entities didn't send from the baseline, unchanged entities are not added
+	bool ArenaStateHistory::ResolveDelta(Packets::ArenaState& state) const
+	{
+		if (state.baselineId == state.stateId)
+			return true; //< Not delta-compressed
+
+		const State* baseline = GetState(state.baselineId);
+		if (!baseline)
+			return false;
+
+		for (Entity& entity : state.entities)
+		{
+			if (entity.fields == Packets::ArenaState::EntityField_All)
+				continue;
+
+			const Entity* baselineEntity = FindEntity(baseline->entities, entity.id);
+			if (!baselineEntity)
+				return false;
+
+			if ((entity.fields & Packets::ArenaState::EntityField_AngularVelocity) == 0)
+				entity.angularVelocity = baselineEntity->angularVelocity;
+
+			if ((entity.fields & Packets::ArenaState::EntityField_LinearVelocity) == 0)
+				entity.linearVelocity = baselineEntity->linearVelocity;
+
+			if ((entity.fields & Packets::ArenaState::EntityField_Position) == 0)
+				entity.position = baselineEntity->position;
+
+			if ((entity.fields & Packets::ArenaState::EntityField_Rotation) == 0)
+				entity.rotation = baselineEntity->rotation;
+
+			entity.fields = Packets::ArenaState::EntityField_All;
+		}
+
+		return true;
+	}
+
+	// Serialized size of an entity, with only its fields
+	std::size_t ArenaStateHistory::ComputeEntitySize(const Entity& entity)
+	{
+		std::size_t size = ComputeIdSize(entity.id) + sizeof(Nz::UInt8);
+
+		if (entity.fields & Packets::ArenaState::EntityField_AngularVelocity)
+			size += QuantizedAngularVelocity::ByteSize;
+
+		if (entity.fields & Packets::ArenaState::EntityField_LinearVelocity)
+			size += QuantizedLinearVelocity::ByteSize;
+
+		if (entity.fields & Packets::ArenaState::EntityField_Position)
+			size += QuantizedPosition::ByteSize;
+
+		if (entity.fields & Packets::ArenaState::EntityField_Rotation)
+			size += QuantizedQuaternion::ByteSize;
+
+		return size;
+	}
+
+	// Ids are compressed seven bits per byte
+	std::size_t ArenaStateHistory::ComputeIdSize(Nz::UInt32 entityId)
+	{
+		std::size_t size = 1;
+		while (entityId >>= 7)
+			size++;
+
+		return size;
+	}
+}
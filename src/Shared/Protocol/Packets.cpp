@@ -6,6 +6,7 @@
 #include <Nazara/Core/Algorithm.hpp>
 #include <Nazara/Math/Vector3.hpp>
 #include <Shared/Utils.hpp>
+#include <stdexcept>
 
 namespace ewn
 {
@@ -131,8 +132,8 @@ namespace ewn
 		void Serialize(PacketSerializer& serializer, ArenaState& data)
 		{
 			serializer &= data.stateId;
+			serializer &= data.baselineId;
 			serializer &= data.serverTime;
-			serializer &= data.lastProcessedInputTime;
 
 			CompressedUnsigned<Nz::UInt32> entityCount;
 			if (serializer.IsWriting())
@@ -145,11 +146,38 @@ namespace ewn
 			for (auto& entity : data.entities)
 			{
 				serializer &= entity.id;
-				serializer &= entity.position;
-				serializer &= entity.rotation;
-				serializer &= entity.angularVelocity;
-				serializer &= entity.linearVelocity;
+				serializer &= entity.fields;
+
+				if (entity.fields & ArenaState::EntityField_Position)
+					serializer &= entity.position;
+
+				if (entity.fields & ArenaState::EntityField_Rotation)
+					serializer &= entity.rotation;
+
+				if (entity.fields & ArenaState::EntityField_AngularVelocity)
+					serializer &= entity.angularVelocity;
+
+				if (entity.fields & ArenaState::EntityField_LinearVelocity)
+					serializer &= entity.linearVelocity;
 			}
+
+			CompressedUnsigned<Nz::UInt32> removedCount;
+			if (serializer.IsWriting())
+				removedCount = Nz::UInt32(data.removedEntities.size());
+
+			serializer &= removedCount;
+			if (!serializer.IsWriting())
+				data.removedEntities.resize(removedCount);
+
+			for (auto& entityId : data.removedEntities)
+				serializer &= entityId;
+
+			serializer &= data.lastProcessedInputTime;
+		}
+
+		void Serialize(PacketSerializer& serializer, ArenaStateAck& data)
+		{
+			serializer &= data.stateId;
 		}
 
 		void Serialize(PacketSerializer& serializer, BotMessage& data)
@@ -166,6 +194,7 @@ namespace ewn
 		void Serialize(PacketSerializer& serializer, ControlEntity& data)
 		{
 			serializer &= data.id;
+			serializer &= data.inertia;
 		}
 
 		void Serialize(PacketSerializer& serializer, CreateEntity& data)
@@ -379,8 +408,27 @@ namespace ewn
 		void Serialize(PacketSerializer& serializer, PlayerMovement& data)
 		{
 			serializer &= data.inputTime;
-			serializer &= data.direction;
-			serializer &= data.rotation;
+
+			CompressedUnsigned<Nz::UInt32> inputCount;
+			if (serializer.IsWriting())
+				inputCount = Nz::UInt32(data.inputs.size());
+
+			serializer &= inputCount;
+			if (!serializer.IsWriting())
+			{
+				// Don't let a client make us allocate or apply an arbitrary number of inputs
+				if (inputCount > PlayerMovement::MaxInputCount)
+					throw std::runtime_error("Too many inputs");
+
+				data.inputs.resize(inputCount);
+			}
+
+			for (auto& input : data.inputs)
+			{
+				serializer &= input.timeOffset;
+				serializer &= input.direction;
+				serializer &= input.rotation;
+			}
 		}
 
 		void Serialize(PacketSerializer& serializer, PlayerShoot& data)
@@ -0,0 +1,83 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/QuantizedTypes.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr float SmallestThreeRange = 0.70710678f; //< 1 / sqrt(2), bounds of the three smallest components of a normalized quaternion
+	}
+
+	QuantizedQuaternion::QuantizedQuaternion(const Nz::Quaternionf& value)
+	{
+		operator=(value);
+	}
+
+	QuantizedQuaternion::operator Nz::Quaternionf() const
+	{
+		constexpr Nz::UInt32 componentMask = (1 << ComponentBits) - 1;
+		constexpr float invScale = SmallestThreeRange / MaxValue;
+
+		std::size_t largestIndex = m_packedValue >> (3 * ComponentBits);
+
+		std::array<float, 4> components;
+		float squaredSum = 0.f;
+		unsigned int offset = 3;
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			if (i == largestIndex)
+				continue;
+
+			Nz::Int32 quantized = static_cast<Nz::Int32>((m_packedValue >> (--offset * ComponentBits)) & componentMask) - MaxValue;
+			components[i] = quantized * invScale;
+			squaredSum += components[i] * components[i];
+		}
+
+		components[largestIndex] = std::sqrt(std::max(1.f - squaredSum, 0.f));
+
+		Nz::Quaternionf rotation(components[0], components[1], components[2], components[3]);
+		return rotation.Normalize();
+	}
+
+	QuantizedQuaternion& QuantizedQuaternion::operator=(const Nz::Quaternionf& value)
+	{
+		constexpr float scale = MaxValue / SmallestThreeRange;
+
+		Nz::Quaternionf rotation = value.GetNormal();
+		std::array<float, 4> components = { rotation.w, rotation.x, rotation.y, rotation.z };
+
+		std::size_t largestIndex = 0;
+		for (std::size_t i = 1; i < 4; ++i)
+		{
+			if (std::abs(components[i]) > std::abs(components[largestIndex]))
+				largestIndex = i;
+		}
+
+		// q and -q represent the same rotation, make the largest component positive so we don't have to send its sign
+		float sign = (components[largestIndex] < 0.f) ? -1.f : 1.f;
+
+		m_packedValue = static_cast<Nz::UInt32>(largestIndex);
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			if (i == largestIndex)
+				continue;
+
+			float component = components[i] * sign;
+			if (!std::isfinite(component))
+				component = 0.f;
+
+			component = Nz::Clamp(component, -SmallestThreeRange, SmallestThreeRange);
+
+			m_packedValue <<= ComponentBits;
+			m_packedValue |= static_cast<Nz::UInt32>(std::lround(component * scale) + MaxValue);
+		}
+
+		return *this;
+	}
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/SpaceshipMovement.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <cmath>
+
+namespace ewn
+{
+	// Movement and rotation are player inputs, as sent in PlayerMovement
+	// Inertia holds the principal moments of inertia of the hull (in local space), as sent in ControlEntity
+	void SpaceshipMovement::ApplyInput(State& state, const Nz::Vector3f& inertia, float inputElapsedTime, const Nz::Vector3f& movement, const Nz::Vector3f& rotation)
+	{
+		Nz::Vector3f force = state.rotation * ComputeForce(inputElapsedTime, movement * MovementScale);
+		state.linearVelocity += force * (PhysicsStepSize / Mass);
+
+		// Without the hull inertia we can't tell how the spaceship will rotate, leave it to the server
+		if (inertia.x <= 0.f || inertia.y <= 0.f || inertia.z <= 0.f)
+			return;
+
+		// Torque is in global space while inertia is in local space
+		Nz::Vector3f localTorque = state.rotation.GetConjugate() * ComputeTorque(inputElapsedTime, rotation * RotationScale);
+		Nz::Vector3f localAngularImpulse = localTorque * PhysicsStepSize;
+
+		state.angularVelocity += state.rotation * Nz::Vector3f(localAngularImpulse.x / inertia.x, localAngularImpulse.y / inertia.y, localAngularImpulse.z / inertia.z);
+	}
+
+	void SpaceshipMovement::Integrate(State& state, float elapsedTime)
+	{
+		if (elapsedTime <= 0.f)
+			return;
+
+		state.position += state.linearVelocity * elapsedTime;
+
+		float angle = state.angularVelocity.GetLength() * elapsedTime;
+		if (!Nz::NumberEquals(angle, 0.f))
+		{
+			// Angular velocity is in global space
+			Nz::Vector3f axis = Nz::Vector3f::Normalize(state.angularVelocity);
+			float halfSin = std::sin(angle / 2.f);
+
+			Nz::Quaternionf deltaRotation(std::cos(angle / 2.f), axis.x * halfSin, axis.y * halfSin, axis.z * halfSin);
+			state.rotation = (deltaRotation * state.rotation).GetNormal();
+		}
+
+		// Same as Newton, which scales velocities by (1 - damping)^(60 * timestep) every step
+		state.angularVelocity *= std::pow(1.f - AngularDamping, DampingRate * elapsedTime);
+		state.linearVelocity *= std::pow(1.f - LinearDamping, DampingRate * elapsedTime);
+	}
+}